@@ -0,0 +1,25 @@
+# NavBar benchmarks. Build together with the library, then run:
+#   ./benchmarks                      - CSV results to stdout
+#   ./benchmarks -o results.xml,xml   - any other QTest output format (Qt 5.3+), or -xml
+# Offscreen platform is used by default on Qt 5, set QT_QPA_PLATFORM to override.
+
+QT += core gui testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = benchmarks
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+SOURCES += navbarbenchmark.cpp
+
+HEADERS += navbarbenchmark.h
+
+CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../lib/ -lnavbar
+else:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../lib/ -lnavbard
+
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+
+CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../lib/libnavbar.a
+else:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../lib/libnavbard.a
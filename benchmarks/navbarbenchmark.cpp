@@ -0,0 +1,583 @@
+#include <QApplication>
+#include <QDialog>
+#include <QGridLayout>
+#include <QLabel>
+#include <QMouseEvent>
+#include <QStandardItemModel>
+#include <QTimer>
+#include <QtTest>
+#include "navbar.h"
+#include "navbarbenchmark.h"
+
+/*
+ * Benchmarks of NavBar hot paths: page list maintenance, relayout on row changes and splitter drag,
+ * collapse/expand, state persistence, options dialog and style switching.
+ * Page counts are given as test data, so results show how each operation scales.
+ */
+
+static const char *const styleFiles[] =
+{
+    ":/styles/office2003gray.css",
+    ":/styles/office2003blue.css",
+    ":/styles/office2003silver.css",
+    ":/styles/office2003green.css",
+    ":/styles/office2007blue.css",
+    ":/styles/office2007black.css",
+    ":/styles/office2007silver.css"
+};
+
+static const NavBarTheme::Preset themePresets[] =
+{
+    NavBarTheme::Office2003Gray,
+    NavBarTheme::Office2003Blue,
+    NavBarTheme::Office2003Silver,
+    NavBarTheme::Office2003Green,
+    NavBarTheme::Office2007Blue,
+    NavBarTheme::Office2007Black,
+    NavBarTheme::Office2007Silver
+};
+
+static const int styleCount = sizeof(styleFiles) / sizeof(styleFiles[0]);
+
+enum StyleMode
+{
+    StyleSheetUncached,
+    StyleSheetCached,
+    NativeTheme
+};
+
+static QIcon pageIcon()
+{
+    QPixmap pixmap(24, 24);
+    pixmap.fill(Qt::darkBlue);
+    return QIcon(pixmap);
+}
+
+static void sendMouseEvent(QWidget *widget, QEvent::Type type, const QPoint &globalPos,
+                           Qt::MouseButton button, Qt::MouseButtons buttons)
+{
+    QMouseEvent e(type, widget->mapFromGlobal(globalPos), globalPos, button, buttons, Qt::NoModifier);
+    QApplication::sendEvent(widget, &e);
+}
+
+void NavBarBenchmark::addPages(NavBar *navBar, int count, int children)
+{
+    QIcon icon = pageIcon();
+    QList<NavBarPageInfo> pageList;
+
+    for(int i = 0; i < count; i++)
+    {
+        QWidget *page = new QWidget;
+
+        if(children > 0)
+        {
+            QGridLayout *layout = new QGridLayout(page);
+            for(int c = 0; c < children; c++)
+                layout->addWidget(new QLabel(QString::number(c)), c / 25, c % 25);
+        }
+
+        pageList.append(NavBarPageInfo(page, QString("Page %1").arg(i), icon));
+    }
+
+    navBar->addPages(pageList);
+}
+
+void NavBarBenchmark::showNavBar(NavBar *navBar, int height)
+{
+    navBar->resize(220, height);
+    navBar->show();
+#if QT_VERSION >= 0x050000
+    QTest::qWaitForWindowExposed(navBar);
+#else
+    QTest::qWaitForWindowShown(navBar);
+#endif
+}
+
+/* Closes options dialog as soon as it is shown. */
+void NavBarBenchmark::acceptOptionsDialog()
+{
+    QDialog *dlg = qobject_cast<QDialog *>(QApplication::activeModalWidget());
+
+    if(dlg)
+        dlg->accept();
+    else
+        QTimer::singleShot(0, this, SLOT(acceptOptionsDialog()));
+}
+
+void NavBarBenchmark::addPage_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("100")  << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void NavBarBenchmark::addPage()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    showNavBar(&navBar, 600);
+    QIcon icon = pageIcon();
+
+    QBENCHMARK_ONCE
+    {
+        for(int i = 0; i < pages; i++)
+            navBar.addPage(new QWidget, QString("Page %1").arg(i), icon);
+    }
+
+    QCOMPARE(navBar.count(), pages);
+}
+
+void NavBarBenchmark::removePage_data()
+{
+    addPage_data();
+}
+
+void NavBarBenchmark::removePage()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+    showNavBar(&navBar, 600);
+
+    QBENCHMARK_ONCE
+    {
+        while(navBar.count() > 0)
+            navBar.removePage(0);
+    }
+}
+
+void NavBarBenchmark::indexOfPage_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("1000")  << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void NavBarBenchmark::indexOfPage()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+
+    QStringList names;
+    for(int i = 0; i < pages; i++)
+        names.append(navBar.pageName(i));
+
+    QBENCHMARK
+    {
+        foreach(const QString &name, names)
+            navBar.indexOfPage(name);
+    }
+
+    QCOMPARE(navBar.indexOfPage(names.last()), pages - 1);
+}
+
+void NavBarBenchmark::setVisibleRows_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("100")  << 100;
+    QTest::newRow("500")  << 500;
+    QTest::newRow("2000") << 2000;
+}
+
+void NavBarBenchmark::setVisibleRows()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+    showNavBar(&navBar, 600);
+
+    QBENCHMARK
+    {
+        for(int rows = 0; rows <= 10; rows++)
+            navBar.setVisibleRows(rows);
+        for(int rows = 10; rows >= 0; rows--)
+            navBar.setVisibleRows(rows);
+    }
+}
+
+void NavBarBenchmark::splitterDrag_data()
+{
+    setVisibleRows_data();
+}
+
+void NavBarBenchmark::splitterDrag()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+    showNavBar(&navBar, 600);
+    navBar.setVisibleRows(3);
+
+    NavBarSplitter *splitter = navBar.findChild<NavBarSplitter *>();
+    QVERIFY(splitter);
+    QSplitterHandle *handle = splitter->handle(1);
+    QVERIFY(qobject_cast<NavBarSplitterHandle *>(handle));
+
+    splitter->resetRelayoutCount();
+
+    // drag handle up by 200 pixels and back, one pixel per mouse event
+    QBENCHMARK
+    {
+        QPoint start = handle->mapToGlobal(handle->rect().center());
+        sendMouseEvent(handle, QEvent::MouseButtonPress, start, Qt::LeftButton, Qt::LeftButton);
+
+        for(int dy = 1; dy <= 200; dy++)
+            sendMouseEvent(handle, QEvent::MouseMove, start - QPoint(0, dy), Qt::NoButton, Qt::LeftButton);
+        for(int dy = 199; dy >= 0; dy--)
+            sendMouseEvent(handle, QEvent::MouseMove, start - QPoint(0, dy), Qt::NoButton, Qt::LeftButton);
+
+        sendMouseEvent(handle, QEvent::MouseButtonRelease, start, Qt::LeftButton, Qt::NoButton);
+    }
+
+    QVERIFY(splitter->relayoutCount() > 0);
+}
+
+void NavBarBenchmark::setCollapsed_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::addColumn<int>("children");
+    QTest::addColumn<bool>("popup");
+    QTest::newRow("10 pages, empty")                << 10 << 0    << false;
+    QTest::newRow("10 pages, 1000 children")        << 10 << 1000 << false;
+    QTest::newRow("10 pages, empty, popup")         << 10 << 0    << true;
+    QTest::newRow("10 pages, 1000 children, popup") << 10 << 1000 << true;
+}
+
+void NavBarBenchmark::setCollapsed()
+{
+    QFETCH(int, pages);
+    QFETCH(int, children);
+    QFETCH(bool, popup);
+
+    NavBar navBar;
+    addPages(&navBar, pages, children);
+    showNavBar(&navBar, 600);
+    navBar.setCollapseDuration(0);
+
+    QBENCHMARK
+    {
+        navBar.setCollapsed(true);
+        QCoreApplication::processEvents();
+        // same as clicking title of collapsed navigation bar, moves pages into popup
+        if(popup)
+        {
+            QMetaObject::invokeMethod(&navBar, "showContentsPopup");
+            QCoreApplication::processEvents();
+        }
+        navBar.setCollapsed(false);
+        QCoreApplication::processEvents();
+    }
+}
+
+void NavBarBenchmark::stateRoundTrip_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("100")   << 100;
+    QTest::newRow("10000") << 10000;
+}
+
+void NavBarBenchmark::stateRoundTrip()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+    for(int i = 0; i < pages; i += 3)
+        navBar.setPageVisible(i, false);
+
+    QByteArray state = navBar.saveState();
+    QVERIFY(navBar.restoreState(state));
+
+    QBENCHMARK
+    {
+        state = navBar.saveState();
+        navBar.restoreState(state);
+    }
+}
+
+void NavBarBenchmark::optionsDialog_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("10")  << 10;
+    QTest::newRow("200") << 200;
+}
+
+void NavBarBenchmark::optionsDialog()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    addPages(&navBar, pages);
+    showNavBar(&navBar, 600);
+
+    QBENCHMARK
+    {
+        QTimer::singleShot(0, this, SLOT(acceptOptionsDialog()));
+        QCOMPARE(navBar.showOptionsDialog(), int(QDialog::Accepted));
+    }
+}
+
+void NavBarBenchmark::loadStyle_data()
+{
+    QTest::addColumn<int>("mode");
+    QTest::newRow("style sheet, uncached") << int(StyleSheetUncached);
+    QTest::newRow("style sheet, cached")   << int(StyleSheetCached);
+    QTest::newRow("native theme")          << int(NativeTheme);
+}
+
+void NavBarBenchmark::loadStyle()
+{
+    QFETCH(int, mode);
+
+    NavBar navBar;
+    addPages(&navBar, 20);
+    showNavBar(&navBar, 600);
+
+    QBENCHMARK
+    {
+        for(int i = 0; i < styleCount; i++)
+        {
+            if(mode == NativeTheme)
+            {
+                navBar.setTheme(NavBarTheme::preset(themePresets[i]));
+            }
+            else
+            {
+                if(mode == StyleSheetUncached)
+                    NavBar::clearStyleCache();
+                navBar.setStyleSheet(NavBar::loadStyle(styleFiles[i]));
+            }
+
+            navBar.repaint();
+        }
+    }
+
+    QVERIFY(!NavBar::loadStyle(styleFiles[0]).isEmpty());
+}
+
+void NavBarBenchmark::quickFilter_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("1000")  << 1000;
+    QTest::newRow("10000") << 10000;
+}
+
+void NavBarBenchmark::quickFilter()
+{
+    QFETCH(int, pages);
+
+    QList<QAction *> actions;
+    NavBarSearchIndex index;
+
+    for(int i = 0; i < pages; i++)
+    {
+        QAction *action = new QAction(this);
+        action->setData(i);
+        actions.append(action);
+        index.insert(action, QString("Customer account %1").arg(i));
+    }
+
+    // user types query letter by letter, then erases it
+    const QString query = "account 12";
+
+    QBENCHMARK
+    {
+        for(int i = 1; i <= query.size(); i++)
+            index.find(query.left(i), 50);
+        index.find(QString(), 50);
+    }
+
+    QVERIFY(!index.find(query, 50).isEmpty());
+    qDeleteAll(actions);
+}
+
+static void fillModel(QStandardItemModel *model, int rows)
+{
+    QIcon icon = pageIcon();
+
+    for(int i = 0; i < rows; i++)
+        model->appendRow(new QStandardItem(icon, QString("Row %1").arg(i)));
+}
+
+/* List model, which moves rows with rowsMoved signal; QStandardItemModel moves rows by removing and inserting them */
+class PageListModel: public QAbstractListModel
+{
+public:
+    explicit PageListModel(int rows): icon(pageIcon())
+    {
+        for(int i = 0; i < rows; i++)
+            texts.append(QString("Row %1").arg(i));
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const
+    {
+        return parent.isValid() ? 0 : texts.size();
+    }
+
+    QVariant data(const QModelIndex &index, int role) const
+    {
+        if(role == Qt::DisplayRole)
+            return texts[index.row()];
+        if(role == Qt::DecorationRole)
+            return icon;
+        return QVariant();
+    }
+
+    void insertText(int row, const QString &text)
+    {
+        beginInsertRows(QModelIndex(), row, row);
+        texts.insert(row, text);
+        endInsertRows();
+    }
+
+    void removeText(int row)
+    {
+        beginRemoveRows(QModelIndex(), row, row);
+        texts.removeAt(row);
+        endRemoveRows();
+    }
+
+    void moveText(int from, int to)
+    {
+        if(!beginMoveRows(QModelIndex(), from, from, QModelIndex(), (to > from) ? to + 1 : to))
+            return;
+        texts.move(from, to);
+        endMoveRows();
+    }
+
+private:
+    QStringList texts;
+    QIcon       icon;
+};
+
+void NavBarBenchmark::modelRows_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::newRow("100")  << 100;
+    QTest::newRow("1000") << 1000;
+}
+
+void NavBarBenchmark::modelRows()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    PageListModel model(pages);
+    navBar.setModel(&model);
+    showNavBar(&navBar, 600);
+
+    // insert a row in the middle, move it to the top and to the bottom, and remove it
+    QBENCHMARK
+    {
+        model.insertText(pages / 2, "Inserted");
+        model.moveText(pages / 2, 0);
+        model.moveText(0, pages);
+        model.removeText(pages);
+    }
+
+    QCOMPARE(navBar.count(), pages);
+}
+
+void NavBarBenchmark::modelDataChanged_data()
+{
+    modelRows_data();
+}
+
+void NavBarBenchmark::modelDataChanged()
+{
+    QFETCH(int, pages);
+
+    NavBar navBar;
+    QStandardItemModel model;
+    fillModel(&model, pages);
+    navBar.setModel(&model);
+    showNavBar(&navBar, 600);
+
+    int n = 0;
+    QBENCHMARK
+    {
+        for(int i = 0; i < 100; i++)
+            model.item(i % pages)->setText(QString("Row %1 (%2)").arg(i).arg(n));
+        n++;
+    }
+}
+
+void NavBarBenchmark::pageCounter_data()
+{
+    QTest::addColumn<int>("pages");
+    QTest::addColumn<bool>("collapsed");
+    QTest::newRow("100")             << 100  << false;
+    QTest::newRow("1000")            << 1000 << false;
+    QTest::newRow("1000, collapsed") << 1000 << true;
+}
+
+void NavBarBenchmark::pageCounter()
+{
+    QFETCH(int, pages);
+    QFETCH(bool, collapsed);
+
+    NavBar navBar;
+    addPages(&navBar, pages, 0);
+    navBar.setCollapseDuration(0);
+    navBar.setCollapsed(collapsed);
+    showNavBar(&navBar, 600);
+
+    // unread counter in the title of the current page
+    int n = 0;
+    QBENCHMARK
+    {
+        navBar.setPageText(0, QString("Inbox (%1)").arg(n++));
+        QCoreApplication::processEvents();
+    }
+}
+
+void NavBarBenchmark::pageBadge_data()
+{
+    pageCounter_data();
+}
+
+void NavBarBenchmark::pageBadge()
+{
+    QFETCH(int, pages);
+    QFETCH(bool, collapsed);
+
+    NavBar navBar;
+    addPages(&navBar, pages, 0);
+    navBar.setCollapseDuration(0);
+    navBar.setCollapsed(collapsed);
+    showNavBar(&navBar, 600);
+
+    // burst of incoming messages, spread over visible and toolbar pages
+    int n = 0;
+    QBENCHMARK
+    {
+        for(int i = 0; i < 1000; i++)
+            navBar.setPageBadge(i % 10, ++n);
+        QCoreApplication::processEvents();
+    }
+}
+
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+
+    QApplication app(argc, argv);
+    Q_INIT_RESOURCE(navbar);
+
+    // machine-readable output by default, any command line arguments override it
+    QStringList args = app.arguments();
+    if(args.size() == 1)
+        args << "-csv";
+
+    NavBarBenchmark benchmark;
+    return QTest::qExec(&benchmark, args);
+}
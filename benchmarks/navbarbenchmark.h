@@ -0,0 +1,50 @@
+#ifndef NAVBARBENCHMARK_H
+#define NAVBARBENCHMARK_H
+
+#include <QObject>
+
+class NavBar;
+
+class NavBarBenchmark : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void addPage_data();
+    void addPage();
+    void removePage_data();
+    void removePage();
+    void indexOfPage_data();
+    void indexOfPage();
+    void setVisibleRows_data();
+    void setVisibleRows();
+    void splitterDrag_data();
+    void splitterDrag();
+    void setCollapsed_data();
+    void setCollapsed();
+    void stateRoundTrip_data();
+    void stateRoundTrip();
+    void optionsDialog_data();
+    void optionsDialog();
+    void loadStyle_data();
+    void loadStyle();
+    void quickFilter_data();
+    void quickFilter();
+    void modelRows_data();
+    void modelRows();
+    void modelDataChanged_data();
+    void modelDataChanged();
+    void pageCounter_data();
+    void pageCounter();
+    void pageBadge_data();
+    void pageBadge();
+
+protected slots:
+    void acceptOptionsDialog();
+
+private:
+    void addPages(NavBar *navBar, int count, int children = 0);
+    void showNavBar(NavBar *navBar, int height);
+};
+
+#endif // NAVBARBENCHMARK_H
@@ -3,7 +3,11 @@ TEMPLATE = subdirs
 SUBDIRS += \
     src \
     example \
-    designerplugin
+    designerplugin \
+    benchmarks \
+    tests
     
 example.depends = src
 designerplugin.depends = src
+benchmarks.depends = src
+tests.depends = src
@@ -6,6 +6,7 @@
 #include <QAction>
 #include <QActionGroup>
 #include <QResizeEvent>
+#include <QActionEvent>
 #include <QAction>
 #include <QList>
 #include <QFile>
@@ -13,6 +14,16 @@
 #include <QGridLayout>
 #include <QSizeGrip>
 #include <QWidgetAction>
+#include <QApplication>
+#include <QBitArray>
+#include <QBuffer>
+#include <QPainter>
+#include <QLabel>
+#include <QTimeLine>
+#include <QStackedLayout>
+#include <QVector>
+#include <QPair>
+#include <algorithm>
 #include "navbar.h"
 #include "navbaroptionsdialog.h"
 
@@ -47,6 +58,24 @@
  * This signal is emitted when navigation bar collapsed or expanded.
  * @param collapsed True if collapsed
  */
+/**
+ * @fn NavBar::pageCreated
+ * This signal is emitted when widget of the page, added with NavBarPageFactory, is created.
+ * @param index Index of the page
+ */
+/**
+ * @fn NavBar::pageUnloaded
+ * This signal is emitted when widget of inactive page is passed to NavBarPageFactory::releasePage().
+ * @param index Index of the page
+ * @see maxLoadedPages, pageUnloadTimeout
+ */
+/**
+ * @fn NavBar::currentChildChanged
+ * This signal is emitted when current child entry of page group is changed.
+ * @param index Index of the group page
+ * @param child Index of child entry, or -1
+ * @see addGroup
+ */
 
 
 /**
@@ -59,6 +88,7 @@ NavBar::NavBar(QWidget *parent, Qt::WindowFlags f):
 {
     collapsedState  = false;
     autoPopupMode   = false;
+    expandedWidth   = 0;
     headerVisible   = true;
     optMenuVisible  = true;
     headerHeight    = 26;
@@ -66,6 +96,46 @@ NavBar::NavBar(QWidget *parent, Qt::WindowFlags f):
     pageIconSize    = QSize(24, 24);
     uniquePageCount = 0;
     proceedCollapse = false;
+    visiblePageListValid = false;
+    nameIndexValid  = false;
+    slotPagesValid  = true;
+    toolBarValid    = false;
+    toolBarRows     = 0;
+    relayoutFrom    = 0;
+    updateLevel     = 0;
+    updatePending   = false;
+    activeHost      = 0;
+    maxLoaded       = 0;
+    unloadTimeout   = 0;
+    preload         = NoPreload;
+    preloadLimit    = 1;
+    preloadSlice    = 10;
+    iconScanPos     = 0;
+    pagesMenuValid  = false;
+    virtualList     = false;
+    contentsInPopup = false;
+    animDuration    = 0;
+    animCollapse    = false;
+    animStartWidth  = 0;
+    animEndWidth    = 0;
+    animHeaderHidden = false;
+    statsEnabled    = false;
+    quickFilter     = 0;
+    pageModel       = 0;
+
+    pageClock.start();
+    unloadTimer = new QTimer(this);
+    connect(unloadTimer, SIGNAL(timeout()), SLOT(unloadExpiredPages()));
+    preloadTimer = new QTimer(this);
+    preloadTimer->setInterval(0);
+    connect(preloadTimer, SIGNAL(timeout()), SLOT(preloadPages()));
+    iconTimer = new QTimer(this);
+    iconTimer->setInterval(0);
+    connect(iconTimer, SIGNAL(timeout()), SLOT(updatePageIcons()));
+    badgeTimer = new QTimer(this);
+    badgeTimer->setSingleShot(true);
+    badgeTimer->setInterval(16);
+    connect(badgeTimer, SIGNAL(timeout()), SLOT(updatePageBadges()));
 
     setFrameStyle(QFrame::Panel | QFrame::Sunken);
 
@@ -79,7 +149,11 @@ NavBar::NavBar(QWidget *parent, Qt::WindowFlags f):
 
     splitter = new NavBarSplitter(this);
     splitter->setOrientation(Qt::Vertical);
-    splitter->addWidget(stackedWidget);
+    QWidget *slotWidget = new QWidget(splitter);
+    contentSlot = new QStackedLayout(slotWidget);
+    contentSlot->setContentsMargins(0, 0, 0, 0);
+    contentSlot->addWidget(stackedWidget);
+    splitter->addWidget(slotWidget);
     splitter->addWidget(pageListWidget);
     splitter->setStretchFactor(0, 1);
     splitter->setStretchFactor(1, 0);
@@ -94,6 +168,36 @@ NavBar::NavBar(QWidget *parent, Qt::WindowFlags f):
     actionOptions = new QAction(this);
     actionOptions->setText(tr("Options..."));
 
+    actionQuickFilter = new QAction(this);
+    actionQuickFilter->setShortcut(QKeySequence(Qt::CTRL + Qt::Key_K));
+    actionQuickFilter->setShortcutContext(Qt::WidgetWithChildrenShortcut);
+    addAction(actionQuickFilter);
+    connect(actionQuickFilter, SIGNAL(triggered()), SLOT(showQuickFilter()));
+
+    QWidget *spacerWidget = new QWidget(pageToolBar);
+    spacerWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
+    spacerAction = pageToolBar->addWidget(spacerWidget);
+
+    QToolButton *menuBtn = new QToolButton(pageToolBar);
+    menuBtn->setMaximumWidth(16);
+    menuBtn->setAutoRaise(true);
+    menuBtn->setPopupMode(QToolButton::InstantPopup);
+    menuBtn->setMenu(pagesMenu);
+    menuButtonAction = pageToolBar->addWidget(menuBtn);
+
+    // pages, which do not fit into toolbar in virtual page list mode
+    overflowMenu = new QMenu(this);
+    QToolButton *overflowBtn = new QToolButton(pageToolBar);
+    overflowBtn->setObjectName("navBarOverflowButton"); //for stylesheets
+    overflowBtn->setText(QString::fromUtf8("\xC2\xBB"));
+    overflowBtn->setMaximumWidth(16);
+    overflowBtn->setAutoRaise(true);
+    overflowBtn->setPopupMode(QToolButton::InstantPopup);
+    overflowBtn->setMenu(overflowMenu);
+    overflowAction = pageToolBar->insertWidget(menuButtonAction, overflowBtn);
+    overflowAction->setVisible(false);
+    overflowFirst = 0;
+
     contentsPopup = new QFrame(this, Qt::Popup);
     contentsPopup->setObjectName("navBarPopup"); //for stylesheets
     contentsPopup->setFrameStyle(QFrame::Panel | QFrame::Plain);
@@ -106,11 +210,22 @@ NavBar::NavBar(QWidget *parent, Qt::WindowFlags f):
     contentsPopup->setLayout(l);
 
     pageTitleButton = new NavBarTitleButton(this);
-    pageTitleButton->setVisible(false);
+    contentSlot->addWidget(pageTitleButton);
+
+    collapseOverlay = new QLabel(this);
+    collapseOverlay->setAlignment(Qt::AlignLeft | Qt::AlignTop);
+    collapseOverlay->setVisible(false);
+    collapseTimeLine = new QTimeLine(0, this);
+    collapseTimeLine->setUpdateInterval(16);
+    collapseTimeLine->setCurveShape(QTimeLine::EaseInOutCurve);
+    connect(collapseTimeLine, SIGNAL(valueChanged(qreal)), SLOT(animateCollapse(qreal)));
+    connect(collapseTimeLine, SIGNAL(finished()),          SLOT(finishCollapseAnimation()));
 
     connect(actionGroup,     SIGNAL(triggered(QAction*)),          SLOT(onClickPageButton(QAction*)));
     connect(pageListWidget,  SIGNAL(buttonVisibilityChanged(int)), SLOT(onButtonVisibilityChanged(int)));
     connect(pagesMenu,       SIGNAL(triggered(QAction*)),          SLOT(changePageVisibility(QAction*)));
+    connect(pagesMenu,       SIGNAL(aboutToShow()),                SLOT(updatePagesMenu()));
+    connect(overflowMenu,    SIGNAL(aboutToShow()),                SLOT(updateOverflowMenu()));
     connect(pageTitleButton, SIGNAL(clicked()),                    SLOT(showContentsPopup()));
     connect(header,          SIGNAL(buttonClicked(bool)),          SLOT(setCollapsed(bool)));
 }
@@ -137,7 +252,7 @@ int NavBar::count() const
  */
 int NavBar::currentIndex() const
 {
-    return stackedWidget->currentIndex();
+    return indexOfSlot(stackedWidget->currentIndex());
 }
 
 /**
@@ -146,7 +261,7 @@ int NavBar::currentIndex() const
  */
 QWidget *NavBar::currentWidget() const
 {
-    return stackedWidget->currentWidget();
+    return widget(currentIndex());
 }
 
 /**
@@ -156,7 +271,16 @@ QWidget *NavBar::currentWidget() const
  */
 int NavBar::indexOf(QWidget *widget) const
 {
-    return stackedWidget->indexOf(widget);
+    int slot = stackedWidget->indexOf(widget);
+
+    if((slot < 0) && widget)
+    {
+        NavBarPageHost *host = qobject_cast<NavBarPageHost *>(widget->parentWidget());
+        if(host)
+            slot = stackedWidget->indexOf(host);
+    }
+
+    return indexOfSlot(slot);
 }
 
 /**
@@ -188,7 +312,7 @@ void NavBar::setShowHeader(bool show)
     if(show != headerVisible)
     {
         headerVisible = show;
-        header->setVisible(show);
+        header->setVisible(show && (!collapsedState || contentsInPopup));
         resizeContent(size(), rowHeight());
     }
 }
@@ -202,7 +326,7 @@ void NavBar::setShowOptionsMenu(bool show)
     if(show != optMenuVisible)
     {
         optMenuVisible = show;
-        refillToolBar(visibleRows());
+        menuButtonAction->setVisible(show);
     }
 }
 
@@ -219,6 +343,8 @@ int NavBar::rowHeight() const
 /**
  * @property NavBar::collapsed
  * Sets navigation bar collapsed state on/off
+ * @note Collapsing and expanding do not reparent page widgets, so they cost the same for any page content.
+ * This does not cover contents popup of collapsed navigation bar, see autoPopup.
  * @access bool isCollaped() const\n void setCollapsed(bool)
  * @signals collapsedChanged(bool)
  */
@@ -230,6 +356,8 @@ bool NavBar::isCollapsed() const
 /**
  * @property NavBar::autoPopup
  * If turned on, navigation bar popup window will appear on page select (when collapsed).
+ * @note Header and pages are moved into popup when it is shown, and moved back on expand,
+ * so expanding after popup was shown costs as much as reparenting all page widgets.
  * @access bool autoPopup() const\n void setAutoPopup(bool)
  */
 bool NavBar::autoPopup() const
@@ -276,31 +404,205 @@ void NavBar::setRowHeight(int height)
 
 /**
  * Toggles navigation bar collapsed state.
+ * If collapseDuration is set, state is changed (and collapsedChanged() emitted) when animation ends.
  * @param collapse Collapsed/Normal
  */
 void NavBar::setCollapsed(bool collapse)
 {
+    if(collapseTimeLine->state() == QTimeLine::Running)
+        finishCollapseAnimation();
+
     if(collapse == collapsedState)
         return;
 
+    bool animate = (animDuration > 0) && isVisible();
+
+    if(animate && collapse)
+        expandedSnapshot = grabSnapshot();
+
+    if(animate && !expandedSnapshot.isNull())
+        startCollapseAnimation(collapse);
+    else
+        applyCollapsed(collapse);
+}
+
+/**
+ * @property NavBar::collapseDuration
+ * This property holds duration of collapse/expand animation in milliseconds.
+ * Animation shows snapshot of navigation bar, so page widgets are not laid out on every frame;
+ * real collapse or expand is done when animation ends. Zero disables animation. Default is 0.
+ * @access int collapseDuration() const\n void setCollapseDuration(int)
+ * @see collapsed
+ */
+int NavBar::collapseDuration() const
+{
+    return animDuration;
+}
+
+/**
+ * Sets duration of collapse/expand animation.
+ * @param msec Duration in milliseconds, 0 disables animation
+ */
+void NavBar::setCollapseDuration(int msec)
+{
+    animDuration = qMax(0, msec);
+}
+
+/**
+ * @property NavBar::statsEnabled
+ * This property holds whether navigation bar collects instrumentation statistics, see stats().
+ * Statistics are also collected, while debug messages of logging category <TT>navbar.stats</TT> are enabled
+ * (Qt 5.4 and later), e.g. with <TT>QT_LOGGING_RULES="navbar.stats.debug=true"</TT>;
+ * in this case time of every operation is logged. Default is false.
+ * @access bool isStatsEnabled() const\n void setStatsEnabled(bool)
+ */
+bool NavBar::isStatsEnabled() const
+{
+    return statsEnabled;
+}
+
+/**
+ * Enables or disables collecting of instrumentation statistics.
+ * @param enable True to enable
+ */
+void NavBar::setStatsEnabled(bool enable)
+{
+    statsEnabled = enable;
+}
+
+/**
+ * Returns instrumentation statistics, collected since creation or last resetStats() call.
+ * @return Statistics
+ * @see statsEnabled
+ */
+NavBarStats NavBar::stats() const
+{
+    return perfStats;
+}
+
+/**
+ * Resets instrumentation statistics.
+ */
+void NavBar::resetStats()
+{
+    perfStats.reset();
+}
+
+/**
+ * @property NavBar::quickFilterShortcut
+ * This property holds keyboard shortcut, which opens quick filter popup, see showQuickFilter().
+ * Shortcut works, while navigation bar or one of its pages has focus. Default is Ctrl+K.
+ * @access QKeySequence quickFilterShortcut() const\n void setQuickFilterShortcut(const QKeySequence &)
+ */
+QKeySequence NavBar::quickFilterShortcut() const
+{
+    return actionQuickFilter->shortcut();
+}
+
+/**
+ * Sets keyboard shortcut, which opens quick filter popup. Empty key sequence disables shortcut.
+ * @param shortcut Shortcut
+ */
+void NavBar::setQuickFilterShortcut(const QKeySequence &shortcut)
+{
+    actionQuickFilter->setShortcut(shortcut);
+}
+
+/* Returns statistics, which should be updated, or 0 if instrumentation is disabled */
+NavBarStats *NavBar::collectStats() const
+{
+#if QT_VERSION >= 0x050400
+    if(statsEnabled || navBarStatsLog().isDebugEnabled())
+#else
+    if(statsEnabled)
+#endif
+        return &perfStats;
+
+    return 0;
+}
+
+QPixmap NavBar::grabSnapshot()
+{
+#if QT_VERSION >= 0x050000
+    return grab();
+#else
+    return QPixmap::grabWidget(this);
+#endif
+}
+
+/*
+ * Covers navigation bar with snapshot and hides real content, so resizing during animation
+ * does not cause relayout of page widgets. When collapsing, current look is shown;
+ * when expanding, snapshot, taken on last collapse, is revealed.
+ */
+void NavBar::startCollapseAnimation(bool collapse)
+{
+    animCollapse   = collapse;
+    animStartWidth = width();
+    animEndWidth   = collapse ? collapsedWidth : expandedWidth;
+
+    if(!collapse)
+        contentsPopup->setVisible(false);
+
+    collapseOverlay->setPixmap(expandedSnapshot);
+    collapseOverlay->setGeometry(rect());
+    collapseOverlay->show();
+    collapseOverlay->raise();
+
+    animHeaderHidden = header->isHidden();
+    header->setVisible(false);
+    splitter->setVisible(false);
+    pageToolBar->setVisible(false);
+
+    setMaximumWidth(QWIDGETSIZE_MAX);
+
+    collapseTimeLine->setDuration(animDuration);
+    collapseTimeLine->start();
+}
+
+void NavBar::animateCollapse(qreal value)
+{
+    int w = animStartWidth + qRound((animEndWidth - animStartWidth) * value);
+
+    setMaximumWidth(w);
+    resize(w, height());
+    collapseOverlay->setGeometry(rect());
+}
+
+void NavBar::finishCollapseAnimation()
+{
+    collapseTimeLine->stop();
+
+    splitter->setVisible(true);
+    pageToolBar->setVisible(true);
+    header->setHidden(animHeaderHidden);
+
+    applyCollapsed(animCollapse);
+
+    if(animCollapse)
+        expandedWidth = animStartWidth;
+
+    collapseOverlay->hide();
+    collapseOverlay->setPixmap(QPixmap());
+}
+
+void NavBar::applyCollapsed(bool collapse)
+{
     proceedCollapse = true;
     collapsedState = collapse;
 
     if(collapse)
     {
-        for(int i = 0; i < pages.size(); i++)
+        foreach(QToolButton *button, pageButtons())
         {
-            pages[i].button->setToolButtonStyle(Qt::ToolButtonIconOnly);
-            pages[i].button->setToolTip(pages[i].text());
+            button->setToolButtonStyle(Qt::ToolButtonIconOnly);
+            button->setToolTip(button->defaultAction() ? button->defaultAction()->text() : QString());
         }
 
-        moveContentsToPopup(true);
-
-        splitter->insertWidget(0, pageTitleButton);
-        pageTitleButton->setVisible(true);
-        splitter->setStretchFactor(0, 1);
-        splitter->setStretchFactor(1, 0);
-        splitter->setCollapsible(0, false);
+        // page content stays in place until popup is shown, so collapse does not reparent it;
+        // popup still takes header and pages, see moveContentsToPopup()
+        header->setVisible(false);
+        contentSlot->setCurrentWidget(pageTitleButton);
 
         expandedWidth = width();
         resize(collapsedWidth, height());
@@ -310,25 +612,25 @@ void NavBar::setCollapsed(bool collapse)
     {
         contentsPopup->setVisible(false);
 
-        for(int i = 0; i < pages.size(); i++)
+        foreach(QToolButton *button, pageButtons())
         {
-            pages[i].button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
-            pages[i].button->setToolTip("");
+            button->setToolButtonStyle(Qt::ToolButtonTextBesideIcon);
+            button->setToolTip("");
         }
 
         setMaximumWidth(QWIDGETSIZE_MAX);
         resize(expandedWidth, height());
 
-        pageTitleButton->setParent(this);
-        pageTitleButton->setVisible(false);
+        if(contentsInPopup)
+            moveContentsToPopup(false);
 
-        moveContentsToPopup(false);
+        contentSlot->setCurrentWidget(stackedWidget);
+        header->setVisible(headerVisible);
     }
 
     header->button->setText(QString::fromUtf8(collapse ? "\xC2\xBB" : "\xC2\xAB"));
 
-    splitter->setVisible(false);
-    splitter->setVisible(true);
+    splitter->refresh();
     resizeContent(size(), rowHeight());
     proceedCollapse = false;
 
@@ -371,10 +673,12 @@ int NavBar::visibleRows() const
  */
 void NavBar::setVisibleRows(int rows)
 {
+    int visCount = visiblePages().size();
+
     if(rows < 0)
         rows = 0;
-    if(rows > visiblePages().size())
-        rows = visiblePages().size();
+    if(rows > visCount)
+        rows = visCount;
 
     int listHeight = rows * rowHeight();
     int pageHeight = splitter->height() - listHeight;
@@ -387,19 +691,102 @@ void NavBar::setVisibleRows(int rows)
 void NavBar::resizeEvent(QResizeEvent *e)
 {
     resizeContent(e->size(), rowHeight());
+
+    if(virtualList && (e->size().width() != e->oldSize().width()))
+        refillToolBar(visibleRows());
+
     QFrame::resizeEvent(e);
 }
 
 void NavBar::changeEvent(QEvent *e)
 {
-    if(e->type() == QEvent::StyleChange)
+    // popup is a separate window, so own style sheet should be copied to it;
+    // style sheet, applied by setApplicationStyle(), reaches popup without that
+    if((e->type() == QEvent::StyleChange) && (contentsPopup->styleSheet() != styleSheet()))
         contentsPopup->setStyleSheet(styleSheet());
 
     QFrame::changeEvent(e);
 }
 
+void NavBar::paintEvent(QPaintEvent *e)
+{
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::Paint);
+
+    if(!paintTheme.isValid())
+    {
+        QFrame::paintEvent(e);
+        return;
+    }
+
+    QPainter p(this);
+    p.setPen(paintTheme.borderColor);
+    p.drawRect(rect().adjusted(0, 0, -1, -1));
+}
+
+/**
+ * Sets theme for native painting mode.
+ * In this mode navigation bar and its parts draw themselves directly from theme colors,
+ * which is much faster than style sheets, see NavBarTheme::preset().
+ * Style sheet should not be set on navigation bar, while it uses theme.
+ * Pass invalid theme (<TT>NavBarTheme()</TT>) to return to style sheet and QStyle painting.
+ *
+ * @par Example:
+ * @code
+   navBar->setTheme(NavBarTheme::preset(NavBarTheme::Office2007Blue));
+   @endcode
+ *
+ * @param theme Theme
+ */
+void NavBar::setTheme(const NavBarTheme &theme)
+{
+    paintTheme = theme;
+    const NavBarTheme *t = activeTheme();
+
+    setFrameStyle(t ? (QFrame::Box | QFrame::Plain) : (QFrame::Panel | QFrame::Sunken));
+    splitter->setHandleWidth(t ? 6 : -1);
+
+    QPalette pal;
+    if(t)
+        pal.setColor(QPalette::Window, t->contentColor);
+    stackedWidget->setPalette(pal);
+    stackedWidget->setAutoFillBackground(t != 0);
+
+    pal = QPalette();
+    if(t)
+        pal.setColor(QPalette::Window, t->popupColor);
+    contentsPopup->setPalette(pal);
+    contentsPopup->setAutoFillBackground(t != 0);
+
+    header->setTheme(t);
+    splitter->setTheme(t);
+    pageToolBar->setTheme(t);
+    pageTitleButton->setTheme(t);
+    foreach(QToolButton *button, pageButtons())
+        static_cast<NavBarButton *>(button)->setTheme(t);
+
+    resizeContent(size(), rowHeight());
+    update();
+}
+
+/**
+ * Returns theme, used for native painting mode.
+ * @return Theme, invalid if navigation bar uses style sheets
+ */
+NavBarTheme NavBar::theme() const
+{
+    return paintTheme;
+}
+
+/* Returns theme, which should be passed to navigation bar parts, or 0 if they paint themselves by style */
+const NavBarTheme *NavBar::activeTheme() const
+{
+    return paintTheme.isValid() ? &paintTheme : 0;
+}
+
 void NavBar::resizeContent(const QSize &size, int rowheight)
 {
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::ResizeContent);
+
     int left, top, right, bottom;
     getContentsMargins(&left, &top, &right, &bottom);
 
@@ -416,31 +803,110 @@ void NavBar::resizeContent(const QSize &size, int rowheight)
 
 void NavBar::reorderStackedWidget()
 {
-    QList<QWidget *> widgets;
-    QWidget *current = stackedWidget->currentWidget();
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::ReorderStackedWidget);
 
-    for(int i = 0; i < stackedWidget->count(); i++)
-        widgets.append(stackedWidget->widget(i));
-
-    for(int i = 0; i < stackedWidget->count(); i++)
-        stackedWidget->removeWidget(stackedWidget->widget(0));
+    // page widgets stay where they are, only mapping is permuted; action data still holds previous page index
+    QVector<int> oldSlots = pageSlots;
 
     for(int i = 0; i < pages.size(); i++)
-        stackedWidget->addWidget(widgets[pages[i].action->data().toInt()]);
+        pageSlots[i] = oldSlots[pages[i].action->data().toInt()];
 
-    stackedWidget->setCurrentWidget(current);
+    rebuildSlotPages();
 }
 
-void NavBar::recalcPageList(bool reorder)
+/*
+ * Page widgets are never moved inside stacked widget: new widget is always appended to it,
+ * and its position is stored in pageSlots at page index.
+ */
+void NavBar::insertPageSlot(int index, int slot)
 {
-    if(reorder)
-        reorderStackedWidget();
+    pageSlots.insert(index, slot);
 
-    for(int i = 0; i < pages.size(); i++)
+    if(slotPagesValid && (index == slotPages.size()))
+        slotPages.append(index);
+    else
+        slotPagesValid = false;
+}
+
+/*
+ * Forgets position of page widget, which is already removed from stacked widget.
+ * Reverse mapping is rebuilt on next lookup, so removing many pages rebuilds it once.
+ */
+void NavBar::removePageSlot(int index)
+{
+    int slot = pageSlots[index];
+    pageSlots.remove(index);
+
+    for(int i = 0; i < pageSlots.size(); i++)
+        if(pageSlots[i] > slot)
+            pageSlots[i]--;
+
+    slotPagesValid = false;
+}
+
+void NavBar::rebuildSlotPages() const
+{
+    slotPages.resize(pageSlots.size());
+
+    for(int i = 0; i < pageSlots.size(); i++)
+        slotPages[pageSlots[i]] = i;
+
+    slotPagesValid = true;
+}
+
+/* Returns index of the page, which widget is at given position in stacked widget, or -1 */
+int NavBar::indexOfSlot(int slot) const
+{
+    if(!slotPagesValid)
+        rebuildSlotPages();
+
+    return ((slot >= 0) && (slot < slotPages.size())) ? slotPages[slot] : -1;
+}
+
+/*
+ * Action data holds page index. It is kept up to date on every insert, remove and reorder,
+ * even while updates are suspended, because reorderStackedWidget() and page activation rely on it.
+ */
+void NavBar::renumberPages(int from)
+{
+    for(int i = from; i < pages.size(); i++)
         pages[i].action->setData(i);
+}
+
+/*
+ * Must be called after pages list is permuted. Mapping of page widgets is updated at once,
+ * layout is delayed while updates are suspended.
+ */
+void NavBar::applyPageOrder()
+{
+    Q_ASSERT(pages.size() == pageSlots.size());
+
+    reorderStackedWidget();
+    renumberPages(0);
+    invalidatePageList();
+
+    // reorder moves everything, so page list, toolbar and menu are rebuilt
+    toolBarValid = false;
+    relayoutFrom = 0;
+    refillPagesMenu();
+
+    if(updateLevel > 0)
+    {
+        updatePending = true;
+        return;
+    }
+
+    recalcPageList();
+    refillToolBar(visibleRows());
+}
+
+void NavBar::recalcPageList()
+{
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::RecalcPageList);
 
     pageListWidget->setMaximumHeight(visiblePages().size() * rowHeight());
-    pageListWidget->layoutButtons(pageListWidget->width());
+    pageListWidget->layoutButtons(pageListWidget->width(), relayoutFrom);
+    relayoutFrom = visiblePages().size();
 }
 
 /**
@@ -462,6 +928,9 @@ void NavBar::setSmallIconSize(const QSize &size)
 {
     pageToolBar->setIconSize(size);
     pageToolBar->setMinimumHeight(pageListWidget->rowHeight());
+
+    iconCache.clear();
+    scheduleIconUpdate();
 }
 
 /**
@@ -483,8 +952,89 @@ void NavBar::setLargeIconSize(const QSize &size)
 {
     pageIconSize = size;
 
-    for(int i = 0; i < pages.size(); i++)
-        pages[i].button->setIconSize(size);
+    foreach(QToolButton *button, pageButtons())
+        button->setIconSize(size);
+
+    iconCache.clear();
+    scheduleIconUpdate();
+}
+
+/**
+ * @property NavBar::virtualPageList
+ * This property holds whether page list is virtualized.
+ * Virtualized page list does not create button for every page: it reuses pool of buttons, sized to number
+ * of visible rows, and bottom toolbar holds only page actions, which fit into it. So memory and layout cost
+ * do not depend on number of pages. Use it for navigation bars with thousands of pages. Default is false.
+ * @access bool isVirtualPageList() const\n void setVirtualPageList(bool)
+ */
+bool NavBar::isVirtualPageList() const
+{
+    return virtualList;
+}
+
+/**
+ * Enables or disables virtualized page list.
+ * @param enable Enable/Disable
+ */
+void NavBar::setVirtualPageList(bool enable)
+{
+    if(enable == virtualList)
+        return;
+
+    virtualList = enable;
+
+    if(enable)
+    {
+        for(int i = 0; i < pages.size(); i++)
+        {
+            delete pages[i].button;
+            pages[i].button = 0;
+        }
+    }
+    else
+    {
+        pageListWidget->clearButtonPool();
+
+        for(int i = 0; i < pages.size(); i++)
+        {
+            pages[i].button = createPageButton();
+            pages[i].button->setDefaultAction(pages[i].action);
+            pages[i].button->setVisible(pages[i].isVisible());
+        }
+    }
+
+    invalidatePageList();
+    toolBarValid = false;
+    relayoutFrom = 0;
+    recalcPageList();
+    refillToolBar(visibleRows());
+}
+
+QToolButton *NavBar::createPageButton()
+{
+    NavBarButton *button = new NavBarButton(pageListWidget);
+    button->setTheme(activeTheme());
+    button->setToolButtonStyle(collapsedState ? Qt::ToolButtonIconOnly : Qt::ToolButtonTextBesideIcon);
+    button->setToolTip("");
+    button->setAutoRaise(true);
+    button->setIconSize(pageIconSize);
+
+    return button;
+}
+
+/* Returns all existing page buttons: one per page, or button pool of virtualized page list */
+QList<QToolButton *> NavBar::pageButtons() const
+{
+    if(virtualList)
+        return pageListWidget->buttons();
+
+    QList<QToolButton *> buttons;
+    buttons.reserve(pages.size());
+
+    foreach(const NavBarPage &page, pages)
+        buttons.append(page.button);
+
+    return buttons;
 }
 
 /**
@@ -559,44 +1109,68 @@ int NavBar::insertPage(int index, QWidget *page, const QString &text, const QIco
     p.action->setObjectName(QString("page-%1").arg(uniquePageCount));
     p.action->setCheckable(true);
     p.action->setText(text);
-    p.action->setIcon(icon);
+    p.setIcon(icon);
+    retainIcon(icon);
 
-    p.button = new NavBarButton(pageListWidget);
-    p.button->setDefaultAction(p.action);
-    p.button->setToolButtonStyle(collapsedState ? Qt::ToolButtonIconOnly : Qt::ToolButtonTextBesideIcon);
-    p.button->setToolTip("");
-    p.button->setAutoRaise(true);
-    p.button->setIconSize(pageIconSize);
-    p.button->setGeometry(0, visiblePages().size() * rowHeight(), pageListWidget->width(), rowHeight()); //TODO: move to NavBarPageListWidget
-    p.button->setVisible(true);
+    if(virtualList)
+        p.button = 0;
+    else
+    {
+        p.button = createPageButton();
+        p.button->setDefaultAction(p.action);
+        p.button->setVisible(true);
+    }
 
-    int oldIdx = stackedWidget->currentIndex();
+    int oldIdx = currentIndex();
 
     int idx;
-    if(index < 0) // add page
+    if((index < 0) || (index >= pages.size())) // add page
     {
-        p.action->setData(pages.size());
-        idx = stackedWidget->addWidget(page);
+        idx = pages.size();
+        p.action->setData(idx);
         pages.append(p);
         pageOrder.append(p.name());
     }
     else // insert page
     {
-        idx = stackedWidget->insertWidget(index, page);
-        pages.insert(index, p);
-        pageOrder.insert(index, p.name());
+        idx = index;
+        pages.insert(idx, p);
+        pageOrder.insert(idx, p.name());
+        renumberPages(idx);
+    }
+
+    insertPageSlot(idx, stackedWidget->addWidget(page));
+    searchIndex.insert(p.action, text);
+    invalidatePageList();
+    addToPageLists(idx);
+
+    if(pagesMenuValid)
+    {
+        QAction *before = (idx+1 < pages.size()) ? pageMenuActions.value(pages[idx+1].action) : 0;
+        pagesMenu->insertAction(before, createPageMenuAction(idx));
     }
 
     uniquePageCount++;
 
-    pages[stackedWidget->currentIndex()].action->setChecked(true);
+    if(!icon.isNull())
+        scheduleIconUpdate();
+
+    pages[currentIndex()].action->setChecked(true);
     actionGroup->addAction(p.action);
-    setHeaderText(pages[stackedWidget->currentIndex()].text());
-    recalcPageList(false);
+    connect(p.action, SIGNAL(changed()), SLOT(onPageActionChanged()));
+
+    if(updateLevel > 0)
+    {
+        updatePending = true;
+        return idx;
+    }
+
+    setHeaderText(pages[currentIndex()].text());
+    recalcPageList();
     refillToolBar(visibleRows());
-    refillPagesMenu();
+    activatePage(currentIndex());
 
-    int newIdx = stackedWidget->currentIndex();
+    int newIdx = currentIndex();
 
     if(oldIdx != newIdx)
         emit currentChanged(newIdx);
@@ -605,50 +1179,759 @@ int NavBar::insertPage(int index, QWidget *page, const QString &text, const QIco
 }
 
 /**
- * Removes widget from the NavBar. i.e., widget is not deleted but simply removed from the navigation bar, causing it to be hidden.
- * @param index Index of widget to be removed
+ * Adds page, which widget will be created by factory on first selection.
+ * @param factory Page factory, navigation bar takes ownership of it
+ * @param text Page text
+ * @return The new page's index
+ * @see NavBarPageFactory, isPageCreated
  */
-void NavBar::removePage(int index)
+int NavBar::addPage(NavBarPageFactory *factory, const QString &text)
 {
-    if((index < 0) || (index > (pages.size()-1)))
-        return;
-
-    int rows = visibleRows();
-
-    stackedWidget->removeWidget(stackedWidget->widget(index));
-    actionGroup->removeAction(pages[index].action);
-    delete pages[index].button;
-    delete pages[index].action;
-    pages.removeAt(index);
-    pageOrder.removeAt(index);
-    recalcPageList(false);
-
-    if(!pages.isEmpty())
-    {
-        setHeaderText(pages[stackedWidget->currentIndex()].text());
-        pages[stackedWidget->currentIndex()].action->setChecked(true);
-    }
-    else
-        setHeaderText("");
-
-    if(rows > visiblePages().size())
-        setVisibleRows(visiblePages().size());
-
-    refillToolBar(visibleRows());
-    refillPagesMenu();
+    return addPage(factory, text, QIcon());
 }
 
 /**
- * Returns the text of the page at given position, or an empty string if index is out of range.
- * @param index Page index
- * @return Page text
- * @see setPageText
- */
+ * Adds page, which widget will be created by factory on first selection.
+ * @param factory Page factory, navigation bar takes ownership of it
+ * @param text Page text
+ * @param icon Page icon
+ * @return The new page's index
+ * @see NavBarPageFactory, isPageCreated
+ */
+int NavBar::addPage(NavBarPageFactory *factory, const QString &text, const QIcon &icon)
+{
+    return insertPage(-1, factory, text, icon);
+}
+
+/**
+ * Inserts page, which widget will be created by factory on first selection.
+ * @param index Page position
+ * @param factory Page factory, navigation bar takes ownership of it
+ * @param text Page text
+ * @return The new page's index
+ * @see NavBarPageFactory, isPageCreated
+ */
+int NavBar::insertPage(int index, NavBarPageFactory *factory, const QString &text)
+{
+    return insertPage(index, factory, text, QIcon());
+}
+
+/**
+ * Inserts page, which widget will be created by factory on first selection.
+ * @param index Page position
+ * @param factory Page factory, navigation bar takes ownership of it
+ * @param text Page text
+ * @param icon Page icon
+ * @return The new page's index
+ * @see NavBarPageFactory, isPageCreated
+ */
+int NavBar::insertPage(int index, NavBarPageFactory *factory, const QString &text, const QIcon &icon)
+{
+    return insertPage(index, new NavBarPageHost(factory), text, icon);
+}
+
+/**
+ * Adds several pages to navigation bar at once. Page list, toolbar and menu are updated only once,
+ * after the last page is added.
+ * @param pageList List of pages to be added
+ * @return Index of the first added page, or -1 if list is empty
+ * @see beginUpdate
+ */
+int NavBar::addPages(const QList<NavBarPageInfo> &pageList)
+{
+    if(pageList.isEmpty())
+        return -1;
+
+    NavBarUpdateLocker locker(this);
+    int first = pages.size();
+
+    foreach(const NavBarPageInfo &info, pageList)
+        insertPage(-1, info.widget, info.text, info.icon);
+
+    return first;
+}
+
+/**
+ * Adds page group. Group content is a list of child entries, created by factory when the group is selected
+ * for the first time.
+ * @param factory Children factory, navigation bar takes ownership of it
+ * @param text Group text
+ * @return The new page's index
+ * @see NavBarGroupFactory, currentChildChanged
+ */
+int NavBar::addGroup(NavBarGroupFactory *factory, const QString &text)
+{
+    return addGroup(factory, text, QIcon());
+}
+
+/**
+ * Adds page group. Group content is a list of child entries, created by factory when the group is selected
+ * for the first time.
+ * @param factory Children factory, navigation bar takes ownership of it
+ * @param text Group text
+ * @param icon Group icon
+ * @return The new page's index
+ * @see NavBarGroupFactory, currentChildChanged
+ */
+int NavBar::addGroup(NavBarGroupFactory *factory, const QString &text, const QIcon &icon)
+{
+    return insertGroup(-1, factory, text, icon);
+}
+
+/**
+ * Inserts page group.
+ * @param index Page position
+ * @param factory Children factory, navigation bar takes ownership of it
+ * @param text Group text
+ * @return The new page's index
+ * @see addGroup
+ */
+int NavBar::insertGroup(int index, NavBarGroupFactory *factory, const QString &text)
+{
+    return insertGroup(index, factory, text, QIcon());
+}
+
+/**
+ * Inserts page group.
+ * @param index Page position
+ * @param factory Children factory, navigation bar takes ownership of it
+ * @param text Group text
+ * @param icon Group icon
+ * @return The new page's index
+ * @see addGroup
+ */
+int NavBar::insertGroup(int index, NavBarGroupFactory *factory, const QString &text, const QIcon &icon)
+{
+    NavBarGroup *group = new NavBarGroup(factory);
+    connect(group, SIGNAL(currentChildChanged(int)), SLOT(onGroupChildChanged(int)));
+
+    int idx = insertPage(index, group, text, icon);
+    pageGroups.insert(pages[idx].action, group);
+
+    return idx;
+}
+
+/**
+ * Returns true if the page at given position is a group, added with addGroup().
+ * @param index Page index
+ * @return Group or not
+ */
+bool NavBar::isGroup(int index) const
+{
+    if((index < 0) || (index > (pages.size()-1)))
+        return false;
+
+    return pageGroups.contains(pages[index].action);
+}
+
+/**
+ * Returns index of current child entry of the group at given position,
+ * or -1 if page is not a group or there is no current child.
+ * @param index Page index
+ * @return Child index
+ * @see setCurrentChild, currentChildChanged
+ */
+int NavBar::currentChild(int index) const
+{
+    if((index < 0) || (index > (pages.size()-1)))
+        return -1;
+
+    NavBarGroup *group = pageGroups.value(pages[index].action);
+    return group ? group->currentChild() : -1;
+}
+
+/**
+ * Sets current child entry of the group at given position.
+ * If children of the group are not created yet, entry becomes current when they are created.
+ * @param index Page index
+ * @param child Child index
+ * @see currentChild
+ */
+void NavBar::setCurrentChild(int index, int child)
+{
+    if((index < 0) || (index > (pages.size()-1)))
+        return;
+
+    NavBarGroup *group = pageGroups.value(pages[index].action);
+    if(group)
+        group->setCurrentChild(child);
+}
+
+void NavBar::onGroupChildChanged(int child)
+{
+    QAction *action = pageGroups.key(qobject_cast<NavBarGroup *>(sender()));
+
+    if(action)
+        emit currentChildChanged(action->data().toInt(), child);
+}
+
+/**
+ * Sets model, which rows are shown as pages. Only top-level rows and the first column are used:
+ * @li <TT>Qt::DisplayRole</TT> - page text;
+ * @li <TT>Qt::DecorationRole</TT> - page icon (QIcon or QPixmap);
+ * @li <TT>NavBar::PageNameRole</TT> - page name, used by saveState(), optional;
+ * @li <TT>NavBar::PageFactoryRole</TT> - NavBarPageFactory pointer, which creates page widget, optional.
+ *     It is requested when the row is inserted. Factory is not owned by navigation bar, it must stay valid
+ *     while the row exists. Rows without factory are shown as empty pages.
+ *
+ * Inserted, removed and moved rows are applied to the page list as a single update per model signal,
+ * sorting and other layout changes only permute existing pages, changed data only updates text and icon of affected pages. Pages, added by addPage(), stay in navigation bar.
+ * Pass 0 to detach the model, pages of its rows are removed. They are removed the same way, when the model is destroyed.
+ *
+ * @par Example:
+ * @code
+   QStandardItemModel *model = new QStandardItemModel(this);
+   QStandardItem *item = new QStandardItem(QIcon(":/images/mail.png"), "Mail");
+   item->setData(QVariant::fromValue<NavBarPageFactory *>(&mailPageFactory), NavBar::PageFactoryRole);
+   model->appendRow(item);
+   navBar->setModel(model);
+   @endcode
+ *
+ * @param model Model, navigation bar does not take ownership of it
+ */
+void NavBar::setModel(QAbstractItemModel *model)
+{
+    if(model == pageModel)
+        return;
+
+    if(pageModel)
+    {
+        disconnect(pageModel, 0, this, 0);
+        if(!modelActions.isEmpty())
+            removeModelRows(0, modelActions.size()-1);
+    }
+
+    pageModel = model;
+
+    if(!pageModel)
+        return;
+
+    connect(pageModel, SIGNAL(rowsInserted(QModelIndex,int,int)), SLOT(onModelRowsInserted(QModelIndex,int,int)));
+    connect(pageModel, SIGNAL(rowsRemoved(QModelIndex,int,int)),  SLOT(onModelRowsRemoved(QModelIndex,int,int)));
+    connect(pageModel, SIGNAL(rowsMoved(QModelIndex,int,int,QModelIndex,int)), SLOT(onModelRowsMoved(QModelIndex,int,int,QModelIndex,int)));
+#if QT_VERSION >= 0x050000
+    connect(pageModel, SIGNAL(dataChanged(QModelIndex,QModelIndex,QVector<int>)), SLOT(onModelDataChanged(QModelIndex,QModelIndex,QVector<int>)));
+#else
+    connect(pageModel, SIGNAL(dataChanged(QModelIndex,QModelIndex)), SLOT(onModelDataChanged(QModelIndex,QModelIndex)));
+#endif
+    connect(pageModel, SIGNAL(modelReset()),    SLOT(onModelReset()));
+    connect(pageModel, SIGNAL(layoutAboutToBeChanged()), SLOT(onModelLayoutAboutToBeChanged()));
+    connect(pageModel, SIGNAL(layoutChanged()), SLOT(onModelLayoutChanged()));
+    connect(pageModel, SIGNAL(destroyed()),     SLOT(onModelDestroyed()));
+
+    int rows = pageModel->rowCount();
+    if(rows > 0)
+        insertModelRows(0, rows-1);
+}
+
+/**
+ * Returns model, set by setModel(), or 0.
+ * @return Model
+ */
+QAbstractItemModel *NavBar::model() const
+{
+    return pageModel;
+}
+
+/* Returns index of the page with given action, or -1. Action data is checked first, as it is usually valid */
+int NavBar::indexOfAction(QAction *action) const
+{
+    if(!action)
+        return -1;
+
+    int idx = action->data().toInt();
+    if((idx >= 0) && (idx < pages.size()) && (pages[idx].action == action))
+        return idx;
+
+    for(int i = 0; i < pages.size(); i++)
+        if(pages[i].action == action)
+            return i;
+
+    return -1;
+}
+
+/*
+ * Page factory of model row. Host deletes it together with the page, while factory of the model stays alive.
+ * It is detached when model is destroyed, because factory of the model may be already destroyed too.
+ */
+class NavBarModelPageFactory: public NavBarPageFactory
+{
+public:
+    explicit NavBarModelPageFactory(NavBarPageFactory *f): factory(f) {}
+
+    QWidget *createPage()               { return factory ? factory->createPage() : new QWidget; }
+    void     releasePage(QWidget *page) { if(factory) factory->releasePage(page); else delete page; }
+    void     detach()                   { factory = 0; }
+
+private:
+    NavBarPageFactory *factory;
+};
+
+static QIcon modelIcon(const QVariant &value)
+{
+    if(value.type() == QVariant::Pixmap)
+        return QIcon(qvariant_cast<QPixmap>(value));
+
+    return qvariant_cast<QIcon>(value);
+}
+
+/* Identifies model decoration by its source pixmap or icon, not by QIcon, which wraps pixmap */
+static qint64 modelIconKey(const QVariant &value)
+{
+    if(value.type() == QVariant::Pixmap)
+        return qvariant_cast<QPixmap>(value).cacheKey();
+
+    return qvariant_cast<QIcon>(value).cacheKey();
+}
+
+/*
+ * New rows are inserted before the page of the row, which follows them, or appended.
+ * Page list, toolbar and menu are updated once, when the locker is released.
+ */
+void NavBar::insertModelRows(int first, int last)
+{
+    NavBarUpdateLocker locker(this);
+
+    int pos = (first < modelActions.size()) ? indexOfAction(modelActions[first]) : -1;
+    if(pos < 0)
+        pos = pages.size();
+
+    for(int row = first; row <= last; row++)
+    {
+        QModelIndex idx = pageModel->index(row, 0);
+        QVariant decoration = idx.data(Qt::DecorationRole);
+        NavBarPageFactory *factory = new NavBarModelPageFactory(idx.data(PageFactoryRole).value<NavBarPageFactory *>());
+
+        int page = insertPage(pos, factory, idx.data(Qt::DisplayRole).toString(), modelIcon(decoration));
+        pages[page].action->setProperty("navBarModelIconKey", modelIconKey(decoration));
+
+        // insertPage() puts new name at the page position in pageOrder, unless it is appended;
+        // pageOrder is not in page order after reorders, so position is checked before use
+        QString name = idx.data(PageNameRole).toString();
+        if(!name.isEmpty())
+        {
+            int orderIdx = page;
+            if(pageOrder.value(orderIdx) != pages[page].name())
+                orderIdx = pageOrder.lastIndexOf(pages[page].name());
+            renamePage(page, orderIdx, name);
+        }
+
+        modelActions.insert(row, pages[page].action);
+        pos = page + 1;
+    }
+}
+
+void NavBar::removeModelRows(int first, int last)
+{
+    NavBarUpdateLocker locker(this);
+
+    for(int row = last; row >= first; row--)
+    {
+        int page = indexOfAction(modelActions.takeAt(row));
+        if(page >= 0)
+            removePageAt(page);
+    }
+}
+
+void NavBar::onModelRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    if(!parent.isValid())
+        insertModelRows(first, last);
+}
+
+void NavBar::onModelRowsRemoved(const QModelIndex &parent, int first, int last)
+{
+    if(!parent.isValid())
+        removeModelRows(first, last);
+}
+
+/*
+ * Moved pages are placed before the page of the row, which follows them in the model,
+ * so order of other pages, possibly changed by user, is kept. Only the mapping of page widgets is permuted.
+ */
+void NavBar::onModelRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row)
+{
+    if(parent.isValid() || destination.isValid())
+        return;
+
+    int count = end - start + 1;
+    int to = (row > end) ? row - count : row;
+
+    QList<QAction *> moved = modelActions.mid(start, count);
+    for(int i = 0; i < count; i++)
+        modelActions.removeAt(start);
+    for(int i = 0; i < count; i++)
+        modelActions.insert(to + i, moved[i]);
+
+    QList<NavBarPage> movedPages;
+    foreach(QAction *action, moved)
+    {
+        int page = indexOfAction(action);
+        if(page >= 0)
+            movedPages.append(pages.takeAt(page));
+    }
+
+    int pos = (to + count < modelActions.size()) ? indexOfAction(modelActions[to + count]) : -1;
+    if(pos < 0)
+        pos = pages.size();
+
+    for(int i = 0; i < movedPages.size(); i++)
+        pages.insert(pos + i, movedPages[i]);
+
+    applyPageOrder();
+}
+
+/*
+ * Only text, icon and name of changed rows are updated, and only if their roles are changed.
+ * Empty roles list means all roles, as models of Qt 4 and many models of Qt 5 report.
+ */
+void NavBar::onModelDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles)
+{
+    if(topLeft.parent().isValid() || (topLeft.column() > 0))
+        return;
+
+    bool textRole = roles.isEmpty() || roles.contains(Qt::DisplayRole);
+    bool iconRole = roles.isEmpty() || roles.contains(Qt::DecorationRole);
+    bool nameRole = roles.isEmpty() || roles.contains(PageNameRole);
+
+    for(int row = topLeft.row(); (row <= bottomRight.row()) && (row < modelActions.size()); row++)
+    {
+        int page = indexOfAction(modelActions[row]);
+        if(page < 0)
+            continue;
+
+        QModelIndex idx = pageModel->index(row, 0);
+
+        if(textRole)
+        {
+            QString text = idx.data(Qt::DisplayRole).toString();
+            if(text != pages[page].text())
+                setPageText(page, text);
+        }
+
+        if(iconRole)
+        {
+            QVariant decoration = idx.data(Qt::DecorationRole);
+            qint64 key = modelIconKey(decoration);
+
+            if(key != pages[page].action->property("navBarModelIconKey").toLongLong())
+            {
+                pages[page].action->setProperty("navBarModelIconKey", key);
+                setPageIcon(page, modelIcon(decoration));
+            }
+        }
+
+        if(nameRole)
+        {
+            QString name = idx.data(PageNameRole).toString();
+            if(!name.isEmpty() && (name != pages[page].name()))
+                setPageName(page, name);
+        }
+    }
+}
+
+void NavBar::onModelReset()
+{
+    NavBarUpdateLocker locker(this);
+
+    if(!modelActions.isEmpty())
+        removeModelRows(0, modelActions.size()-1);
+
+    int rows = pageModel->rowCount();
+    if(rows > 0)
+        insertModelRows(0, rows-1);
+}
+
+/* Rows are remembered before layout change, e.g. sorting, so their pages can be permuted afterwards */
+void NavBar::onModelLayoutAboutToBeChanged()
+{
+    layoutIndexes.clear();
+
+    for(int row = 0; row < modelActions.size(); row++)
+        layoutIndexes.append(QPersistentModelIndex(pageModel->index(row, 0)));
+}
+
+/*
+ * Pages of model rows take positions, which model pages occupied before, in new row order.
+ * Other pages stay in place, and page widgets are not touched: only mapping is permuted.
+ * If rows were not just reordered, pages are rebuilt as on model reset.
+ */
+void NavBar::onModelLayoutChanged()
+{
+    QList<QPersistentModelIndex> indexes = layoutIndexes;
+    layoutIndexes.clear();
+
+    int rows = pageModel->rowCount();
+    if((indexes.size() != modelActions.size()) || (rows != modelActions.size()))
+    {
+        onModelReset();
+        return;
+    }
+
+    QVector<QAction *> actions(rows, 0);
+    QVector<bool> assigned(rows, false);
+
+    for(int i = 0; i < indexes.size(); i++)
+    {
+        const QPersistentModelIndex &idx = indexes[i];
+
+        if(!idx.isValid() || idx.parent().isValid() || assigned[idx.row()])
+        {
+            onModelReset();
+            return;
+        }
+
+        actions[idx.row()] = modelActions[i];
+        assigned[idx.row()] = true;
+    }
+
+    QVector<int> positions;
+    QList<NavBarPage> rowPages;
+
+    for(int row = 0; row < rows; row++)
+    {
+        modelActions[row] = actions[row];
+
+        int page = indexOfAction(actions[row]);
+        if(page >= 0) // page of the row may be removed directly
+        {
+            positions.append(page);
+            rowPages.append(pages[page]);
+        }
+    }
+
+    std::sort(positions.begin(), positions.end());
+
+    for(int i = 0; i < positions.size(); i++)
+        pages[positions[i]] = rowPages[i];
+
+    applyPageOrder();
+}
+
+/*
+ * Pages of destroyed model are removed, as by setModel(0). Model data is gone at this point,
+ * so page widgets are deleted directly, without factories of the model.
+ */
+void NavBar::onModelDestroyed()
+{
+    foreach(QAction *action, modelActions)
+    {
+        NavBarPageHost *host = pageHost(indexOfAction(action));
+        if(host)
+            static_cast<NavBarModelPageFactory *>(host->factory())->detach();
+    }
+
+    pageModel = 0;
+    layoutIndexes.clear();
+
+    if(!modelActions.isEmpty())
+        removeModelRows(0, modelActions.size()-1);
+}
+
+/**
+ * Suspends updates of page list, toolbar and pages menu until matching endUpdate() call.
+ * Use it to speed up adding, removing or hiding a lot of pages.
+ * Calls may be nested, currentChanged signal is also delayed until the last endUpdate().
+ * @par Example:
+ * @code
+   navBar->beginUpdate();
+   for(int i = 0; i < modules.size(); i++)
+       navBar->addPage(modules[i]->widget(), modules[i]->title(), modules[i]->icon());
+   navBar->endUpdate();
+   @endcode
+ * @see endUpdate, NavBarUpdateLocker
+ */
+void NavBar::beginUpdate()
+{
+    if(updateLevel++ == 0)
+    {
+        updatePending      = false;
+        updateRows         = visibleRows();
+        updateCurrentIndex = currentIndex();
+    }
+}
+
+/**
+ * Resumes updates, suspended by beginUpdate(), and applies all delayed changes.
+ * @see beginUpdate
+ */
+void NavBar::endUpdate()
+{
+    if((updateLevel == 0) || (--updateLevel > 0))
+        return;
+
+    if(updatePending)
+    {
+        updatePending = false;
+        recalcPageList();
+
+        if(!pages.isEmpty())
+        {
+            setHeaderText(pages[currentIndex()].text());
+            pages[currentIndex()].action->setChecked(true);
+        }
+        else
+            setHeaderText("");
+
+        if(updateRows > visiblePages().size())
+            setVisibleRows(visiblePages().size());
+
+        refillToolBar(visibleRows());
+    }
+
+    activatePage(currentIndex());
+
+    if(currentIndex() != updateCurrentIndex)
+        emit currentChanged(currentIndex());
+}
+
+/**
+ * Returns true if updates are suspended by beginUpdate().
+ * @return Updates suspended or not
+ */
+bool NavBar::isUpdating() const
+{
+    return updateLevel > 0;
+}
+
+/**
+ * Removes widget from the NavBar. i.e., widget is not deleted but simply removed from the navigation bar, causing it to be hidden.
+ * Pages, added with NavBarPageFactory, are passed to NavBarPageFactory::releasePage(), then their factories are deleted.
+ * @param index Index of widget to be removed
+ */
+void NavBar::removePage(int index)
+{
+    if((index < 0) || (index > (pages.size()-1)))
+        return;
+
+    int row = modelActions.indexOf(pages[index].action);
+    if(row >= 0) // page of model row is removed directly, row stays without page
+        modelActions[row] = 0;
+
+    removePageAt(index);
+}
+
+/* Removes page, which is not (or no more) referenced by model rows */
+void NavBar::removePageAt(int index)
+{
+    int rows = visibleRows();
+
+    NavBarPageHost *host = pageHost(index);
+    if(host)
+    {
+        if(activeHost == host)
+            activeHost = 0;
+        loadedHosts.removeOne(host);
+        recentHosts.removeOne(host);
+        preloadQueue.removeOne(host);
+    }
+
+    // next page (or previous, if the last one is removed) becomes current, as stacked widget does by itself
+    if((stackedWidget->currentIndex() == pageSlots[index]) && (pages.size() > 1))
+        stackedWidget->setCurrentIndex(pageSlots[(index < pages.size()-1) ? index+1 : index-1]);
+
+    stackedWidget->removeWidget(stackedWidget->widget(pageSlots[index]));
+    removePageSlot(index);
+    if(host) // factory may keep or save created page
+        host->release();
+    delete host;
+    searchIndex.remove(pages[index].action);
+    badgeQueue.remove(pages[index].action);
+    pageGroups.remove(pages[index].action);
+    actionGroup->removeAction(pages[index].action);
+    if(pages[index].isVisible())
+        removeFromPageLists(index);
+    delete pageMenuActions.take(pages[index].action);
+
+    releaseIcon(pages[index].icon());
+    delete pages[index].button;
+    delete pages[index].action;
+    int orderIdx = pageOrder.indexOf(pages[index].name()); // not at page index after reorder
+    if(orderIdx >= 0)
+        pageOrder.removeAt(orderIdx);
+    pages.removeAt(index);
+    renumberPages(index);
+    invalidatePageList();
+
+    if(updateLevel > 0)
+    {
+        updatePending = true;
+        return;
+    }
+
+    recalcPageList();
+
+    if(!pages.isEmpty())
+    {
+        setHeaderText(pages[currentIndex()].text());
+        pages[currentIndex()].action->setChecked(true);
+    }
+    else
+        setHeaderText("");
+
+    if(rows > visiblePages().size())
+        setVisibleRows(visiblePages().size());
+
+    refillToolBar(visibleRows());
+    activatePage(currentIndex());
+}
+
+/**
+ * Returns the text of the page at given position, or an empty string if index is out of range.
+ * @param index Page index
+ * @return Page text
+ * @see setPageText
+ */
 QString NavBar::pageText(int index) const
 {
     return pages[index].text();
 }
 
+/**
+ * Returns the name of the page at given position. Page names identify pages in saveState() data.
+ * By default pages are named <tt>page-N</tt>, where N is a sequence number of the page in the order of addition.
+ * @param index Page index
+ * @return Page name
+ * @see setPageName, indexOfPage
+ */
+QString NavBar::pageName(int index) const
+{
+    return pages[index].name();
+}
+
+/**
+ * Sets the name of the page at given position. Names must be unique within navigation bar.
+ * Set persistent page names, if pages are not always added in the same order, to make saved state restorable.
+ * @param index Page index
+ * @param name New name
+ * @see pageName, indexOfPage
+ */
+void NavBar::setPageName(int index, const QString &name)
+{
+    renamePage(index, pageOrder.indexOf(pages[index].name()), name);
+}
+
+/* orderIdx is position of the page in pageOrder, or -1 if it is not there */
+void NavBar::renamePage(int index, int orderIdx, const QString &name)
+{
+    if(orderIdx >= 0)
+        pageOrder[orderIdx] = name;
+
+    pages[index].setName(name);
+    nameIndexValid = false;
+}
+
+/**
+ * Returns the index of the page with given name, or -1 if there is no such page.
+ * @param name Page name
+ * @return Page index
+ * @see pageName
+ */
+int NavBar::indexOfPage(const QString &name) const
+{
+    return pageNameIndex().value(name, -1);
+}
+
 /**
  * Returns true if the page at given position is enabled; otherwise returns false.
  * @param index Page index
@@ -668,10 +1951,29 @@ bool NavBar::isPageEnabled(int index)
  */
 void NavBar::setPageVisible(int index, bool visible)
 {
+    if(pages[index].isVisible() == visible)
+        return;
+
     int rows = visibleRows();
 
+    if(!visible)
+        removeFromPageLists(index);
     pages[index].setVisible(visible);
-    recalcPageList(false);
+    if(visible)
+        addToPageLists(index);
+    invalidatePageList();
+
+    QAction *menuAction = pageMenuActions.value(pages[index].action);
+    if(menuAction)
+        menuAction->setChecked(visible);
+
+    if(updateLevel > 0)
+    {
+        updatePending = true;
+        return;
+    }
+
+    recalcPageList();
     refillToolBar(visibleRows());
 
     if(rows > visiblePages().size())
@@ -713,13 +2015,26 @@ QIcon NavBar::pageIcon(int index) const
 
 /**
  * Sets the text of the page at given position.
+ * Only parts, which show this page, are updated: its buttons, header and title of the current page,
+ * and its entry in the pages menu. So the text may be changed often, e.g. to show a counter.
  * @param index Page index
  * @param text New text
  * @see pageText
  */
 void NavBar::setPageText(int index, const QString &text)
 {
+    if(pages[index].text() == text)
+        return;
+
     pages[index].setText(text);
+    searchIndex.insert(pages[index].action, text);
+
+    if(index == currentIndex())
+        setHeaderText(text);
+
+    QAction *menuAction = pageMenuActions.value(pages[index].action);
+    if(menuAction)
+        menuAction->setText(text);
 }
 
 /**
@@ -728,19 +2043,232 @@ void NavBar::setPageText(int index, const QString &text)
  * @param icon New icon
  * @see pageIcon
  */
-void NavBar::setPageIcon(int index, const QIcon &icon)
+void NavBar::setPageIcon(int index, const QIcon &icon)
+{
+    retainIcon(icon);
+    releaseIcon(pages[index].icon());
+    pages[index].setIcon(icon);
+
+    if(icon.isNull())
+        return;
+
+    // icons, which were shown before, are taken from cache without rescanning all pages
+    QHash<qint64, QIcon>::const_iterator it = iconCache.constFind(icon.cacheKey());
+    if(it != iconCache.constEnd())
+        pages[index].setDisplayIcon(it.value());
+    else
+        scheduleIconUpdate();
+}
+
+/**
+ * Sets the badge of the page at given position. Badge is a short text, e.g. unread count,
+ * which is painted over page buttons and toolbar buttons of the page. It does not change page text
+ * and button sizes, so it is cheap to update.
+ *
+ * Page buttons are repainted at most once per frame (16 ms), so badge may be updated as often as needed.
+ * @param index Page index
+ * @param badge Badge text, or empty string to remove badge
+ * @see pageBadge
+ */
+void NavBar::setPageBadge(int index, const QString &badge)
+{
+    if(pages[index].badge() == badge)
+        return;
+
+    pages[index].setBadge(badge);
+    badgeQueue.insert(pages[index].action);
+
+    if(!badgeTimer->isActive())
+        badgeTimer->start();
+}
+
+/**
+ * Sets the badge of the page at given position to a counter.
+ * @param index Page index
+ * @param count Counter value; badge is removed if count is zero or negative
+ * @see pageBadge
+ */
+void NavBar::setPageBadge(int index, int count)
+{
+    setPageBadge(index, (count > 0) ? QString::number(count) : QString());
+}
+
+/**
+ * Returns the badge of the page at given position.
+ * @param index Page index
+ * @return Badge text, or empty string if page has no badge
+ * @see setPageBadge
+ */
+QString NavBar::pageBadge(int index) const
+{
+    return pages[index].badge();
+}
+
+/**
+ * Returns the widget at given index, or 0 if there is no such widget.
+ * For pages, added with NavBarPageFactory, 0 is returned until page widget is created.
+ * @param index Widget index
+ * @return Widget
+ * @see isPageCreated
+ */
+QWidget *NavBar::widget(int index) const
+{
+    NavBarPageHost *host = pageHost(index);
+
+    if(host)
+        return host->page();
+
+    if((index < 0) || (index >= pageSlots.size()))
+        return 0;
+
+    return stackedWidget->widget(pageSlots[index]);
+}
+
+/**
+ * Returns true if widget of the page at given position exists.
+ * Pages, added with NavBarPageFactory, are created on first selection.
+ * @param index Page index
+ * @return Created or not
+ * @see pageCreated
+ */
+bool NavBar::isPageCreated(int index) const
+{
+    NavBarPageHost *host = pageHost(index);
+
+    if(host)
+        return host->isCreated();
+
+    return (index >= 0) && (index < stackedWidget->count());
+}
+
+/**
+ * Unloads widget of the page at given position. Only pages, added with NavBarPageFactory, can be unloaded,
+ * current page is never unloaded. Page widget is passed to NavBarPageFactory::releasePage()
+ * and will be created again, when page is selected.
+ * @param index Page index
+ * @return True if page was unloaded
+ * @see maxLoadedPages, pageUnloadTimeout
+ */
+bool NavBar::unloadPage(int index)
+{
+    return unloadHost(pageHost(index));
+}
+
+/**
+ * @property NavBar::maxLoadedPages
+ * This property holds maximum number of created widgets of pages, added with NavBarPageFactory.
+ * When this limit is exceeded, least recently used pages are unloaded. 0 means no limit (default).
+ * @access int maxLoadedPages() const\n void setMaxLoadedPages(int)
+ * @see pageUnloadTimeout, unloadPage
+ */
+int NavBar::maxLoadedPages() const
+{
+    return maxLoaded;
+}
+
+/**
+ * Sets maximum number of created widgets of pages, added with NavBarPageFactory.
+ * @param count Number of pages, 0 means no limit
+ */
+void NavBar::setMaxLoadedPages(int count)
+{
+    maxLoaded = qMax(0, count);
+    applyPageLimit();
+}
+
+/**
+ * @property NavBar::pageUnloadTimeout
+ * This property holds time in milliseconds, after which inactive page, added with NavBarPageFactory, is unloaded.
+ * Pages are checked periodically, so actual delay may be up to twice as long. 0 means never (default).
+ * @access int pageUnloadTimeout() const\n void setPageUnloadTimeout(int)
+ * @see maxLoadedPages, unloadPage
+ */
+int NavBar::pageUnloadTimeout() const
+{
+    return unloadTimeout;
+}
+
+/**
+ * Sets time, after which inactive page, added with NavBarPageFactory, is unloaded.
+ * @param msec Time in milliseconds, 0 means never
+ */
+void NavBar::setPageUnloadTimeout(int msec)
+{
+    unloadTimeout = qMax(0, msec);
+
+    if(unloadTimeout > 0)
+        unloadTimer->start(unloadTimeout);
+    else
+        unloadTimer->stop();
+}
+
+/**
+ * @property NavBar::preloadMode
+ * This property controls, which pages, added with NavBarPageFactory, are created in advance when event loop is idle:
+ *   - NavBar::NoPreload - pages are created only when selected (default);
+ *   - NavBar::PreloadAdjacent - pages next to the current one in the page list;
+ *   - NavBar::PreloadRecent - recently used pages, which were unloaded.
+ *
+ * @access PreloadMode preloadMode() const\n void setPreloadMode(PreloadMode)
+ * @see preloadCount, preloadSliceTime
+ */
+NavBar::PreloadMode NavBar::preloadMode() const
+{
+    return preload;
+}
+
+/**
+ * Sets, which pages are created in advance when event loop is idle.
+ * @param mode Preload mode
+ */
+void NavBar::setPreloadMode(PreloadMode mode)
+{
+    preload = mode;
+    schedulePreload(currentIndex());
+}
+
+/**
+ * @property NavBar::preloadCount
+ * This property holds number of pages, which are created in advance after page switch. Default is 1.
+ * In PreloadAdjacent mode this is the number of visible neighbours on each side of the current page.
+ * @access int preloadCount() const\n void setPreloadCount(int)
+ * @see preloadMode
+ */
+int NavBar::preloadCount() const
+{
+    return preloadLimit;
+}
+
+/**
+ * Sets number of pages, which are created in advance after page switch.
+ * @param count Number of pages
+ */
+void NavBar::setPreloadCount(int count)
+{
+    preloadLimit = qMax(0, count);
+    schedulePreload(currentIndex());
+}
+
+/**
+ * @property NavBar::preloadSliceTime
+ * This property holds time in milliseconds, which may be spent on page creation before control is returned
+ * to the event loop. At least one page is created per slice. Default is 10 ms.
+ * The same limit applies to rendering of page icons.
+ * @access int preloadSliceTime() const\n void setPreloadSliceTime(int)
+ * @see preloadMode
+ */
+int NavBar::preloadSliceTime() const
 {
-    pages[index].setIcon(icon);
+    return preloadSlice;
 }
 
 /**
- * Returns the widget at given index, or 0 if there is no such widget.
- * @param index Widget index
- * @return Widget
+ * Sets time, which may be spent on page creation before control is returned to the event loop.
+ * @param msec Time in milliseconds
  */
-QWidget *NavBar::widget(int index) const
+void NavBar::setPreloadSliceTime(int msec)
 {
-    return stackedWidget->widget(index);
+    preloadSlice = qMax(0, msec);
 }
 
 QSize NavBar::sizeHint() const
@@ -757,10 +2285,14 @@ void NavBar::setCurrentIndex(int index)
     if((index < 0) || (index > (pages.size()-1)))
         return;
 
-    stackedWidget->setCurrentIndex(index);
+    // stacked widget is switched first, so page limit, applied on activation, may unload the previous page
+    stackedWidget->setCurrentIndex(pageSlots[index]);
+    activatePage(index);
     setHeaderText(pages[index].text());
     pages[index].action->setChecked(true);
-    emit currentChanged(index);
+
+    if(updateLevel == 0)
+        emit currentChanged(index);
 }
 
 /**
@@ -769,14 +2301,7 @@ void NavBar::setCurrentIndex(int index)
  */
 void NavBar::setCurrentWidget(QWidget *widget)
 {
-    if(pages.isEmpty())
-        return;
-
-    stackedWidget->setCurrentWidget(widget);
-    int index = stackedWidget->currentIndex();
-    setHeaderText(pages[index].text());
-    pages[index].action->setChecked(true);
-    emit currentChanged(index);
+    setCurrentIndex(indexOf(widget));
 }
 
 /**
@@ -791,25 +2316,53 @@ int NavBar::showOptionsDialog()
 
     int ret = optionsDlg.exec();
 
-    if(ret == QDialog::Accepted)
+    // dialog must return the same pages, only reordered
+    QList<NavBarPage> pageList = optionsDlg.pageList();
+    if((ret == QDialog::Accepted) && (pageList.size() == pages.size()))
     {
-        pages = optionsDlg.pageList();
-        recalcPageList(true);
-        refillToolBar(visibleRows());
-        refillPagesMenu();
+        pages = pageList;
+        applyPageOrder();
     }
 
     return ret;
 }
 
+/**
+ * Shows quick filter popup, which allows to find page by typing part of its text and activate it with Enter key.
+ * Popup is also shown by quickFilterShortcut.
+ */
+void NavBar::showQuickFilter()
+{
+    if(!quickFilter)
+    {
+        quickFilter = new NavBarQuickFilter(&searchIndex, this);
+        connect(quickFilter, SIGNAL(activated(QAction*)), SLOT(onQuickFilterActivated(QAction*)));
+    }
+
+    quickFilter->popup(mapToGlobal(QPoint(0, 0)), qMax(width(), 240));
+}
+
+void NavBar::onQuickFilterActivated(QAction *action)
+{
+    // page could be removed while popup was shown
+    if(!actionGroup->actions().contains(action))
+        return;
+
+    setCurrentIndex(action->data().toInt());
+
+    if(autoPopupMode && collapsedState)
+        showContentsPopup();
+}
+
 void NavBar::onClickPageButton(QAction *action)
 {
-    int current = stackedWidget->currentIndex();
+    int current = currentIndex();
     int index = action->data().toInt();
 
     if(index != current)
     {
-        stackedWidget->setCurrentIndex(index);
+        stackedWidget->setCurrentIndex(pageSlots[index]);
+        activatePage(index);
         setHeaderText(action->text());
         emit currentChanged(index);
     }
@@ -818,61 +2371,432 @@ void NavBar::onClickPageButton(QAction *action)
         showContentsPopup();
 }
 
+/*
+ * Toolbar holds persistent spacer, overflow and options buttons, and page actions between them.
+ * It is rebuilt only after reorder; added, removed, shown and hidden pages update it themselves,
+ * so usually only actions crossing visCount boundary are moved.
+ */
 void NavBar::refillToolBar(int visCount)
 {
-    pageToolBar->clear();
-    QWidget *spacerWidget = new QWidget(this);
-    spacerWidget->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Preferred);
-    spacerWidget->setVisible(true);
-    pageToolBar->addWidget(spacerWidget);
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::RefillToolBar);
+
+    const QList<NavBarPage> &visPages = visiblePages();
 
-    for(int i = 0; i < visiblePages().size(); i++)
-        if(i > visCount-1)
-            pageToolBar->addAction(visiblePages()[i].action);
+    if(visCount < 0)
+        visCount = 0;
+    if(visCount > visPages.size())
+        visCount = visPages.size();
 
-    if(optMenuVisible)
+    if(virtualList)
     {
-        QToolButton *menuBtn = new QToolButton;
-        menuBtn->setMaximumWidth(16);
-        menuBtn->setAutoRaise(true);
-        menuBtn->setPopupMode(QToolButton::InstantPopup);
-        menuBtn->setMenu(pagesMenu);
-        pageToolBar->addWidget(menuBtn);
+        // only actions, which fit into toolbar, are added, so it does not create button for every page;
+        // the rest is reachable from overflow menu
+        foreach(QAction *action, pageToolBar->actions())
+            if((action != spacerAction) && (action != overflowAction) && (action != menuButtonAction))
+                pageToolBar->removeAction(action);
+
+        int last = qMin(visPages.size(), visCount + toolBarCapacity());
+        for(int i = visCount; i < last; i++)
+            pageToolBar->insertAction(overflowAction, visPages[i].action);
+
+        overflowFirst = last;
+        overflowAction->setVisible(last < visPages.size());
+
+        toolBarValid = false;
+        toolBarRows = visCount;
+        return;
+    }
+
+    if(!toolBarValid)
+    {
+        foreach(QAction *action, pageToolBar->actions())
+            if((action != spacerAction) && (action != overflowAction) && (action != menuButtonAction))
+                pageToolBar->removeAction(action);
+
+        for(int i = visCount; i < visPages.size(); i++)
+            pageToolBar->insertAction(overflowAction, visPages[i].action);
+
+        overflowAction->setVisible(false);
+        toolBarValid = true;
+    }
+    else if(visCount < toolBarRows)
+    {
+        QAction *before = (toolBarRows < visPages.size()) ? visPages[toolBarRows].action : overflowAction;
+
+        for(int i = visCount; i < toolBarRows; i++)
+            pageToolBar->insertAction(before, visPages[i].action);
     }
+    else
+    {
+        for(int i = toolBarRows; i < visCount; i++)
+            pageToolBar->removeAction(visPages[i].action);
+    }
+
+    toolBarRows = visCount;
 }
 
+/*
+ * Returns number of page actions, which fit into toolbar in virtual page list mode.
+ * Space for overflow button is always reserved, so toolbar never hides actions in its own extension.
+ */
+int NavBar::toolBarCapacity() const
+{
+    int itemWidth = pageToolBar->iconSize().width() + 8;
+    int freeWidth = pageToolBar->width() - 16 - (menuButtonAction->isVisible() ? 16 : 0);
+
+    return qMax(1, freeWidth / itemWidth);
+}
+
+/*
+ * Overflow menu is filled only when it is about to show. It holds page actions themselves,
+ * so triggering menu item switches page the same way as page button does.
+ */
+void NavBar::updateOverflowMenu()
+{
+    const QList<NavBarPage> &visPages = visiblePages();
+
+    overflowMenu->clear();
+
+    for(int i = overflowFirst; i < visPages.size(); i++)
+        overflowMenu->addAction(visPages[i].action);
+}
+
+/*
+ * Page menu is filled only when it is about to show. Once filled, entries of added, removed
+ * and hidden pages are updated one by one, and only reorder makes it filled again.
+ */
 void NavBar::refillPagesMenu()
 {
+    pagesMenuValid = false;
+}
+
+QAction *NavBar::createPageMenuAction(int index)
+{
+    QAction *changeVis = new QAction(pages[index].text(), pagesMenu);
+    changeVis->setCheckable(true);
+    changeVis->setChecked(pages[index].isVisible());
+    changeVis->setData(QVariant::fromValue(static_cast<QObject *>(pages[index].action)));
+    pageMenuActions.insert(pages[index].action, changeVis);
+
+    return changeVis;
+}
+
+void NavBar::updatePagesMenu()
+{
+    if(pagesMenuValid)
+        return;
+
+    NavBarStatsScope statsScope(collectStats(), NavBarStats::RefillPagesMenu);
+
+    pagesMenuValid = true;
     pagesMenu->clear();
+    pageMenuActions.clear();
     pagesMenu->addAction(actionOptions);
     pagesMenu->addSeparator();
 
     for(int i = 0; i < pages.size(); i++)
-    {
-        QAction *changeVis = pagesMenu->addAction(pages[i].text());
-        changeVis->setCheckable(true);
-        changeVis->setChecked(pages[i].isVisible());
-        changeVis->setData(i);
-    }
+        pagesMenu->addAction(createPageMenuAction(i));
 }
 
+/*
+ * Header and pages are moved to popup only when popup is shown for the first time after collapse,
+ * and moved back on expand. So collapsing and expanding without opening popup does not touch page widgets.
+ * Popup is a separate window, so once it was shown, both moves reparent and repolish every page widget,
+ * and their cost grows with page content size (see setCollapsed benchmark with popup).
+ */
 void NavBar::moveContentsToPopup(bool popup)
 {
     if(popup)
     {
         qobject_cast<QGridLayout *>(contentsPopup->layout())->addWidget(header, 0, 0);
         qobject_cast<QGridLayout *>(contentsPopup->layout())->addWidget(stackedWidget, 1, 0);
+        header->setVisible(headerVisible);
+        stackedWidget->setVisible(true);
     }
     else
     {
         contentsPopup->layout()->removeWidget(stackedWidget);
         contentsPopup->layout()->removeWidget(header);
 
-        splitter->insertWidget(0, stackedWidget);
-        stackedWidget->setVisible(true);
+        contentSlot->insertWidget(0, stackedWidget);
         header->setParent(this, Qt::Widget);
-        header->setVisible(headerVisible);
     }
+
+    contentsInPopup = popup;
+}
+
+NavBarPageHost *NavBar::pageHost(int index) const
+{
+    if((index < 0) || (index >= pageSlots.size()))
+        return 0;
+
+    return qobject_cast<NavBarPageHost *>(stackedWidget->widget(pageSlots[index]));
+}
+
+/*
+ * Called when page becomes current. Creates page widget if necessary, moves page to the head
+ * of the recently used list and unloads pages, exceeding maxLoadedPages limit.
+ */
+void NavBar::activatePage(int index)
+{
+    NavBarPageHost *host = pageHost(index);
+    qint64 now = pageClock.elapsed();
+
+    if(activeHost && (activeHost != host))
+        activeHost->setLastActivated(now);
+
+    activeHost = host;
+
+    if(host)
+    {
+        host->setLastActivated(now);
+
+        if(!host->isCreated() && host->create())
+            emit pageCreated(index);
+
+        if(host->isCreated())
+        {
+            loadedHosts.removeOne(host);
+            loadedHosts.prepend(host);
+        }
+
+        recentHosts.removeOne(host);
+        recentHosts.prepend(host);
+
+        applyPageLimit();
+    }
+
+    schedulePreload(index);
+}
+
+/*
+ * Fills preload queue with lazy pages, which are likely to be selected next.
+ */
+void NavBar::schedulePreload(int index)
+{
+    preloadQueue.clear();
+
+    if((preload == NoPreload) || (index < 0))
+    {
+        preloadTimer->stop();
+        return;
+    }
+
+    if(preload == PreloadAdjacent)
+    {
+        int below = index+1;
+        int above = index-1;
+
+        // Only the nearest visible neighbours are considered, created ones are counted too,
+        // so pages far from the current one are never built ahead of time.
+        for(int n = 0; n < preloadLimit; n++)
+        {
+            for(; (below < pages.size()) && !pages[below].isVisible(); below++);
+
+            if(below < pages.size())
+                enqueuePreload(pageHost(below++));
+
+            for(; (above >= 0) && !pages[above].isVisible(); above--);
+
+            if(above >= 0)
+                enqueuePreload(pageHost(above--));
+        }
+    }
+    else
+    {
+        for(int i = 0; (i < recentHosts.size()) && (preloadQueue.size() < preloadLimit); i++)
+            if(recentHosts[i] != activeHost)
+                enqueuePreload(recentHosts[i]);
+    }
+
+    if(preloadQueue.isEmpty())
+        preloadTimer->stop();
+    else
+        preloadTimer->start();
+}
+
+void NavBar::enqueuePreload(NavBarPageHost *host)
+{
+    if(host && !host->isCreated())
+        preloadQueue.append(host);
+}
+
+/*
+ * Called by zero-interval timer, i.e. when event loop is idle. Creates queued pages until
+ * preloadSliceTime is spent, remaining pages are created on next timer shot.
+ */
+void NavBar::preloadPages()
+{
+    QElapsedTimer slice;
+    slice.start();
+
+    while(!preloadQueue.isEmpty())
+    {
+        if((maxLoaded > 0) && (loadedHosts.size() >= maxLoaded))
+        {
+            preloadQueue.clear();
+            break;
+        }
+
+        NavBarPageHost *host = preloadQueue.takeFirst();
+
+        if(!host->isCreated() && host->create())
+        {
+            loadedHosts.append(host);
+            emit pageCreated(indexOfSlot(stackedWidget->indexOf(host)));
+        }
+
+        if(slice.elapsed() >= preloadSlice)
+            break;
+    }
+
+    if(preloadQueue.isEmpty())
+        preloadTimer->stop();
+}
+
+/*
+ * Page icons are rendered once at small and large icon size and stored in cache, keyed by source icon.
+ * Pre-rendered icon is shared by page button, toolbar and menu, so SVG and other scalable icons
+ * are not rendered again on each state change. Rendering is done in idle time slices, because
+ * QIcon and QPixmap can not be used outside of GUI thread.
+ */
+void NavBar::scheduleIconUpdate()
+{
+    iconScanPos = 0;
+    iconTimer->start();
+}
+
+/*
+ * Called by badge timer. Repaints buttons of pages, which badges were changed since last call.
+ * Page buttons and toolbar buttons are associated with page action, as its default action.
+ */
+void NavBar::updatePageBadges()
+{
+    foreach(QAction *action, badgeQueue)
+    {
+        pageToolBar->updateBadge(action);
+
+        foreach(QWidget *widget, action->associatedWidgets())
+            if(qobject_cast<QToolButton *>(widget))
+                widget->update();
+    }
+
+    badgeQueue.clear();
+}
+
+/*
+ * Called by zero-interval timer. Replaces source page icons by pre-rendered ones,
+ * until preloadSliceTime is spent.
+ */
+void NavBar::updatePageIcons()
+{
+    QElapsedTimer slice;
+    slice.start();
+
+    while(iconScanPos < pages.size())
+    {
+        NavBarPage &page = pages[iconScanPos++];
+        QIcon source = page.icon();
+
+        if(source.isNull())
+            continue;
+
+        QHash<qint64, QIcon>::const_iterator it = iconCache.constFind(source.cacheKey());
+        if(it == iconCache.constEnd())
+            it = iconCache.insert(source.cacheKey(), renderIcon(source));
+
+        if(page.action->icon().cacheKey() != it.value().cacheKey())
+            page.setDisplayIcon(it.value());
+
+        if(slice.elapsed() >= preloadSlice)
+            return;
+    }
+
+    iconTimer->stop();
+}
+
+/*
+ * Pre-rendered icons are kept only while some page uses their source icon,
+ * so replaced icons of removed pages and changing model decorations do not pile up in cache.
+ */
+void NavBar::retainIcon(const QIcon &source)
+{
+    if(!source.isNull())
+        iconRefs[source.cacheKey()]++;
+}
+
+void NavBar::releaseIcon(const QIcon &source)
+{
+    if(source.isNull())
+        return;
+
+    QHash<qint64, int>::iterator it = iconRefs.find(source.cacheKey());
+    if((it != iconRefs.end()) && (--it.value() <= 0))
+    {
+        iconCache.remove(it.key());
+        iconRefs.erase(it);
+    }
+}
+
+QIcon NavBar::renderIcon(const QIcon &source) const
+{
+#if QT_VERSION >= 0x050600
+    qreal ratio = devicePixelRatioF();
+#endif
+
+    QIcon icon;
+    QSize sizes[2] = { smallIconSize(), largeIconSize() };
+
+    for(int i = 0; i < 2; i++)
+    {
+        QPixmap pixmap = source.pixmap(sizes[i]);
+#if QT_VERSION >= 0x050600
+        if(pixmap.devicePixelRatio() < ratio)
+        {
+            // raster icons are never scaled up, smaller pixmap would be shown at fraction of icon size
+            QPixmap hiDpi = source.pixmap(sizes[i] * ratio);
+            if(hiDpi.size() == sizes[i] * ratio)
+            {
+                hiDpi.setDevicePixelRatio(ratio);
+                pixmap = hiDpi;
+            }
+        }
+#endif
+        if(!pixmap.isNull())
+            icon.addPixmap(pixmap);
+    }
+
+    return icon.isNull() ? source : icon;
+}
+
+void NavBar::applyPageLimit()
+{
+    if(maxLoaded <= 0)
+        return;
+
+    for(int i = loadedHosts.size()-1; (i >= 0) && (loadedHosts.size() > maxLoaded); i--)
+        unloadHost(loadedHosts[i]);
+}
+
+bool NavBar::unloadHost(NavBarPageHost *host)
+{
+    if(!host || !host->isCreated() || (host == activeHost))
+        return false;
+
+    loadedHosts.removeOne(host);
+    host->release();
+    emit pageUnloaded(indexOfSlot(stackedWidget->indexOf(host)));
+
+    return true;
+}
+
+void NavBar::unloadExpiredPages()
+{
+    qint64 now = pageClock.elapsed();
+
+    for(int i = loadedHosts.size()-1; i >= 0; i--)
+        if(now - loadedHosts[i]->lastActivated() >= unloadTimeout)
+            unloadHost(loadedHosts[i]);
 }
 
 void NavBar::setHeaderText(const QString &text)
@@ -881,15 +2805,140 @@ void NavBar::setHeaderText(const QString &text)
     pageTitleButton->setText(text);
 }
 
-QList<NavBarPage> NavBar::visiblePages()
+/*
+ * Page buttons show page text as tool tip in collapsed mode only. QToolButton copies tool tip
+ * from its action on every action change (text, icon, enabled or checked state), so it is restored
+ * for buttons of changed page. Action notifies widgets before changed() signal, so tool tip is set last.
+ */
+void NavBar::onPageActionChanged()
+{
+    int index = indexOfAction(qobject_cast<QAction *>(sender()));
+
+    if(index >= 0)
+        updatePageToolTip(index);
+}
+
+void NavBar::updatePageToolTip(int index)
+{
+    QAction *action = pages[index].action;
+    QString toolTip = collapsedState ? action->text() : QString();
+
+    if(!virtualList)
+    {
+        pages[index].button->setToolTip(toolTip);
+        return;
+    }
+
+    foreach(QToolButton *button, pageListWidget->buttons())
+        if(button->defaultAction() == action)
+            button->setToolTip(toolTip);
+}
+
+/*
+ * Returns pages, which are not hidden by user. The list is cached and rebuilt only after
+ * invalidatePageList() call, because it is used on every resize and splitter move.
+ */
+const QList<NavBarPage> &NavBar::visiblePages() const
+{
+    if(!visiblePageListValid)
+    {
+        visiblePageList.clear();
+
+        for(int i = 0; i < pages.size(); i++)
+            if(pages[i].isVisible())
+                visiblePageList.append(pages[i]);
+
+        visiblePageListValid = true;
+    }
+
+    return visiblePageList;
+}
+
+/*
+ * Returns hash, which maps page names to page indexes. It is rebuilt only after invalidatePageList() call.
+ */
+const QHash<QString, int> &NavBar::pageNameIndex() const
+{
+    if(!nameIndexValid)
+    {
+        nameIndex.clear();
+        nameIndex.reserve(pages.size());
+
+        for(int i = 0; i < pages.size(); i++)
+            nameIndex.insert(pages[i].name(), i);
+
+        nameIndexValid = true;
+    }
+
+    return nameIndex;
+}
+
+/*
+ * Must be called whenever pages are added, removed, renamed, reordered or change visibility.
+ * Toolbar is not rebuilt: added, removed, shown and hidden pages update it with addToPageLists()
+ * and removeFromPageLists(), and reorder invalidates it explicitly.
+ */
+void NavBar::invalidatePageList()
+{
+    visiblePageListValid = false;
+    nameIndexValid = false;
+}
+
+/*
+ * Must be called after visible page at given index is inserted or shown. Its action is put into toolbar,
+ * if the page does not fit into page list, and buttons from its row downwards are relaid out.
+ */
+void NavBar::addToPageLists(int index)
+{
+    // only rows above relayoutFrom and toolBarRows matter, so pages below them are not counted
+    int limit = qMax(relayoutFrom, toolBarValid ? toolBarRows : 0);
+    int row = 0;
+    for(int i = 0; (i < index) && (row < limit); i++)
+        if(pages[i].isVisible())
+            row++;
+
+    relayoutFrom = qMin(relayoutFrom, row);
+
+    if(!toolBarValid)
+        return;
+
+    if(row < toolBarRows) // page takes place in page list, toolbar actions are one row further now
+    {
+        toolBarRows++;
+        return;
+    }
+
+    QAction *before = overflowAction;
+    for(int i = index+1; i < pages.size(); i++)
+        if(pages[i].isVisible())
+        {
+            before = pages[i].action;
+            break;
+        }
+
+    pageToolBar->insertAction(before, pages[index].action);
+}
+
+/*
+ * Must be called before visible page at given index is removed or hidden; counterpart of addToPageLists().
+ */
+void NavBar::removeFromPageLists(int index)
 {
-    QList<NavBarPage> l;
-
-    for(int i = 0; i < pages.size(); i++)
+    int limit = qMax(relayoutFrom, toolBarValid ? toolBarRows : 0);
+    int row = 0;
+    for(int i = 0; (i < index) && (row < limit); i++)
         if(pages[i].isVisible())
-            l.append(pages[i]);
+            row++;
+
+    relayoutFrom = qMin(relayoutFrom, row);
+
+    if(!toolBarValid)
+        return;
 
-    return l;
+    if(row < toolBarRows)
+        toolBarRows--;
+    else
+        pageToolBar->removeAction(pages[index].action);
 }
 
 void NavBar::onButtonVisibilityChanged(int visCount)
@@ -903,13 +2952,22 @@ void NavBar::onButtonVisibilityChanged(int visCount)
 void NavBar::changePageVisibility(QAction *action)
 {
     if(action == actionOptions)
+    {
         showOptionsDialog();
-    else
-        setPageVisible(action->data().toInt(), action->isChecked());
+        return;
+    }
+
+    // menu entry holds page action, so entries are not renumbered, when pages are added or removed
+    int index = indexOfAction(qobject_cast<QAction *>(action->data().value<QObject *>()));
+    if(index >= 0)
+        setPageVisible(index, action->isChecked());
 }
 
 void NavBar::showContentsPopup()
 {
+    if(!contentsInPopup)
+        moveContentsToPopup(true);
+
     if(contentsPopup->size().isEmpty())
         contentsPopup->resize(expandedWidth, height());
 
@@ -917,125 +2975,526 @@ void NavBar::showContentsPopup()
     contentsPopup->show();
 }
 
+/*
+ * State data layout:
+ *   quint32 NavBarStateMarker, quint16 format, quint16 QDataStream version, qint32 user version,
+ *   quint32 length of records, followed by records: quint16 tag, quint32 payload length, payload.
+ * Unknown records are skipped, so newer versions may add records without breaking older readers.
+ * Total length lets reader stop at the end of state, so state may be followed by other data in the same device.
+ */
+struct NavBar::SavedState
+{
+    int   rows;
+    int   current;
+    bool  collapsed;
+    int   expandedWidth;
+    QVector<QPair<int, bool> > pageList; // page index and visibility, in saved order
+
+    struct Group
+    {
+        int  page;
+        bool expanded;
+        int  child;
+    };
+    QVector<Group> groups;
+};
+
+/* Size of QString, serialized by QDataStream: length prefix and UTF-16 data */
+static inline quint32 stateStringSize(const QString &str)
+{
+    return 4 + 2 * str.size();
+}
+
+static inline void writeStateRecord(QDataStream &stream, quint16 tag, quint32 length)
+{
+    stream << tag;
+    stream << length;
+}
+
+/*
+ * Reads string, but only if its length prefix fits into remaining data,
+ * so corrupted data can not cause huge allocation.
+ */
+static bool readStateString(QDataStream &stream, QString &str)
+{
+    QIODevice *dev = stream.device();
+    uchar prefix[4];
+
+    if(dev->peek(reinterpret_cast<char *>(prefix), 4) != 4)
+        return false;
+
+    quint32 bytes = (quint32(prefix[0]) << 24) | (quint32(prefix[1]) << 16) | (quint32(prefix[2]) << 8) | quint32(prefix[3]);
+
+    if((bytes != 0xffffffff) && (bytes > dev->bytesAvailable() - 4))
+        return false;
+
+    stream >> str;
+    return stream.status() == QDataStream::Ok;
+}
+
 /**
  * Saves the current state of navigation bar.
+ * Pages are identified by their names, see setPageName().
  * @param version Version number, which be stored as part of the data
  * @return State data
  */
 QByteArray NavBar::saveState(int version) const
 {
     QByteArray data;
-    QDataStream stream(&data, QIODevice::WriteOnly);
+    data.reserve(stateSize());
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+    saveState(&buffer, version);
+
+    return data;
+}
+
+/**
+ * Writes the current state of navigation bar to device.
+ * Record lengths are computed in advance, so device does not need to support seeking.
+ * @param device Device, opened for writing
+ * @param version Version number, which be stored as part of the data
+ * @return True if successfull
+ * @sa stateSize()
+ */
+bool NavBar::saveState(QIODevice *device, int version) const
+{
+    if(!device || !device->isWritable())
+        return false;
+
+    QDataStream stream(device);
+
+    stream << quint32(NavBarStateMarker);
+    stream << quint16(NavBarStateFormat);
+    stream << quint16(stream.version());
+    stream << qint32(version);
+    stream << quint32(stateSize() - NavBarStateHeaderSize);
+
+    writeStateRecord(stream, VisibleRowsTag, 4);
+    stream << qint32(visibleRows());
+
+    if(currentIndex() >= 0)
+    {
+        const QString name = pages[currentIndex()].name();
+        writeStateRecord(stream, CurrentPageTag, stateStringSize(name));
+        stream << name;
+    }
 
-    stream << NavBarMarker;
-    stream << version;
-    stream << visibleRows();
-    stream << currentIndex();
+    writeStateRecord(stream, CollapsedTag, 1);
     stream << collapsedState;
-    stream << expandedWidth;
-    stream << pages.size();
 
+    writeStateRecord(stream, ExpandedWidthTag, 4);
+    stream << qint32(expandedWidth);
+
+    quint32 length = 4;
+    foreach(const NavBarPage &page, pages)
+        length += stateStringSize(page.name()) + 1;
+
+    writeStateRecord(stream, PagesTag, length);
+    stream << quint32(pages.size());
     foreach(const NavBarPage &page, pages)
     {
         stream << page.name();
         stream << page.isVisible();
     }
 
-    return data;
+    if(!pageGroups.isEmpty())
+    {
+        QHash<QAction *, NavBarGroup *>::const_iterator it;
+
+        length = 4;
+        for(it = pageGroups.constBegin(); it != pageGroups.constEnd(); ++it)
+            length += stateStringSize(it.key()->objectName()) + 5;
+
+        // group is expanded, while its children exist; groups are written in page order,
+        // so the same state is always saved as the same bytes
+        writeStateRecord(stream, GroupsTag, length);
+        stream << quint32(pageGroups.size());
+        foreach(const NavBarPage &page, pages)
+        {
+            NavBarGroup *group = pageGroups.value(page.action);
+            if(!group)
+                continue;
+
+            stream << page.name();
+            stream << (group->childList() != 0);
+            stream << qint32(group->currentChild());
+        }
+    }
+
+    return stream.status() == QDataStream::Ok;
+}
+
+/**
+ * Returns number of bytes, which saveState() will write for the current state.
+ * Can be used to reserve caller-provided buffer in advance.
+ * @return Size of state data in bytes
+ */
+int NavBar::stateSize() const
+{
+    int size = NavBarStateHeaderSize;
+    size += 6 + 4;              // visible rows
+    size += 6 + 1;              // collapsed state
+    size += 6 + 4;              // expanded width
+    size += 6 + 4;              // page list
+
+    if(currentIndex() >= 0)
+        size += 6 + stateStringSize(pages[currentIndex()].name());
+
+    foreach(const NavBarPage &page, pages)
+        size += stateStringSize(page.name()) + 1;
+
+    if(!pageGroups.isEmpty())
+    {
+        size += 6 + 4;          // group list
+
+        foreach(QAction *action, pageGroups.keys())
+            size += stateStringSize(action->objectName()) + 5;
+    }
+
+    return size;
 }
 
 /**
  * Restores the state of navigation bar.
+ * Pages, missing in the state data, are placed after restored ones; saved pages, missing in navigation bar, are ignored.
+ * State data is read in place, without detaching.
  * @param state State data
  * @param version Version number
- * @return True if successfull
+ * @return True if successfull, false if data is corrupted or version number does not match
  */
 bool NavBar::restoreState(const QByteArray &state, int version)
 {
-    QByteArray data = state;
-    QDataStream stream(&data, QIODevice::ReadOnly);
+    QBuffer buffer;
+    buffer.setData(state);
+    buffer.open(QIODevice::ReadOnly);
 
-    int magic, ver, rows, cur, size, expwidth;
-    bool colstate;
+    return restoreState(&buffer, version);
+}
+
+/**
+ * Restores the state of navigation bar from device.
+ * Reading stops at the end of state data, so device may hold other data after it.
+ * If state can not be restored, position of random-access device is restored too.
+ * Sequential devices are read into memory before parsing, and can not be rewound on failure;
+ * state data of earlier versions, which does not store its length, is read till the end of sequential device.
+ * @param device Device, opened for reading
+ * @param version Version number
+ * @return True if successfull, false if data is corrupted or version number does not match
+ */
+bool NavBar::restoreState(QIODevice *device, int version)
+{
+    if(!device || !device->isReadable())
+        return false;
+
+    if(device->isSequential())
+    {
+        QDataStream headerStream(device->peek(NavBarStateHeaderSize));
+        quint32 magic, length;
+        quint16 format, streamVersion;
+        qint32 ver;
+
+        headerStream >> magic >> format >> streamVersion >> ver >> length;
+
+        if((headerStream.status() != QDataStream::Ok) || (magic != NavBarStateMarker))
+            return restoreState(device->readAll(), version);
+
+        if((format < NavBarStateFormat) || (length > device->bytesAvailable() - NavBarStateHeaderSize))
+            return false;
+
+        return restoreState(device->read(NavBarStateHeaderSize + length), version);
+    }
+
+    qint64 start = device->pos();
+
+    SavedState saved;
+    if(!parseState(device, version, saved))
+    {
+        device->seek(start);
+        return false;
+    }
+
+    applyState(saved);
+    return true;
+}
 
+/* Reads state data of any supported format, starting at current position of device */
+bool NavBar::parseState(QIODevice *device, int version, SavedState &saved) const
+{
+    QDataStream stream(device);
+
+    saved.rows          = visibleRows();
+    saved.current       = -1;
+    saved.collapsed     = collapsedState;
+    saved.expandedWidth = expandedWidth;
+
+    quint32 magic;
     stream >> magic;
+
+    if(magic == NavBarStateMarker)
+        return readState(stream, version, saved);
+    if(magic == NavBarMarker)
+        return readLegacyState(stream, version, saved);
+
+    return false;
+}
+
+bool NavBar::readState(QDataStream &stream, int version, SavedState &saved) const
+{
+    quint16 format, streamVersion;
+    qint32 ver;
+
+    stream >> format;
+    stream >> streamVersion;
     stream >> ver;
 
-    if((magic != NavBarMarker) || (ver != version))
+    if((stream.status() != QDataStream::Ok) || (format < NavBarStateFormat) || (ver != version))
+        return false;
+
+    QIODevice *dev = stream.device();
+    quint32 total;
+    stream >> total;
+
+    if((stream.status() != QDataStream::Ok) || (total > dev->bytesAvailable()))
         return false;
 
+    qint64 end = dev->pos() + total;
+
+    stream.setVersion(streamVersion);
+
+    const QHash<QString, int> &nameIdx = pageNameIndex();
+    QBitArray restored(pages.size());
+    QString name;
+
+    while(dev->pos() < end)
+    {
+        quint16 tag;
+        quint32 length;
+
+        stream >> tag;
+        stream >> length;
+
+        if((stream.status() != QDataStream::Ok) || (length > end - dev->pos()))
+            return false;
+
+        qint64 next = dev->pos() + length;
+
+        switch(tag)
+        {
+        case VisibleRowsTag:
+        {
+            qint32 rows;
+            stream >> rows;
+            saved.rows = rows;
+            break;
+        }
+        case CurrentPageTag:
+            if(!readStateString(stream, name))
+                return false;
+            saved.current = nameIdx.value(name, -1);
+            break;
+        case CollapsedTag:
+            stream >> saved.collapsed;
+            break;
+        case ExpandedWidthTag:
+        {
+            qint32 width;
+            stream >> width;
+            saved.expandedWidth = width;
+            break;
+        }
+        case PagesTag:
+        {
+            quint32 count;
+            stream >> count;
+
+            if(count > length / 5) // each entry takes at least 5 bytes
+                return false;
+
+            for(quint32 i = 0; i < count; i++)
+            {
+                bool visible;
+
+                if(!readStateString(stream, name))
+                    return false;
+                stream >> visible;
+
+                int idx = nameIdx.value(name, -1);
+                if((idx >= 0) && !restored.testBit(idx))
+                {
+                    restored.setBit(idx);
+                    saved.pageList.append(qMakePair(idx, visible));
+                }
+            }
+            break;
+        }
+        case GroupsTag:
+        {
+            quint32 count;
+            stream >> count;
+
+            if(count > length / 9) // each entry takes at least 9 bytes
+                return false;
+
+            for(quint32 i = 0; i < count; i++)
+            {
+                SavedState::Group group;
+                qint32 child;
+
+                if(!readStateString(stream, name))
+                    return false;
+                stream >> group.expanded;
+                stream >> child;
+
+                group.page  = nameIdx.value(name, -1);
+                group.child = child;
+                if((group.page >= 0) && pageGroups.contains(pages[group.page].action))
+                    saved.groups.append(group);
+            }
+            break;
+        }
+        default:
+            break;
+        }
+
+        if((stream.status() != QDataStream::Ok) || (dev->pos() > next) || !dev->seek(next))
+            return false;
+    }
+
+    return true;
+}
+
+/*
+ * Reads data, written by saveState() of previous navbar versions:
+ * int NavBarMarker, int version, int rows, int current, bool collapsed, int expanded width,
+ * int page count, followed by page names and visibility flags.
+ */
+bool NavBar::readLegacyState(QDataStream &stream, int version, SavedState &saved) const
+{
+    qint32 ver, rows, cur, expwidth, size;
+    bool colstate;
+
+    stream >> ver;
     stream >> rows;
     stream >> cur;
     stream >> colstate;
     stream >> expwidth;
     stream >> size;
 
-    if((rows > pages.size()) || (cur > pages.size()-1) || (size > pages.size()))
+    if((stream.status() != QDataStream::Ok) || (ver != version) || (size < 0))
         return false;
 
-    QStringList order;
-    QList<bool> visibility;
+    const QHash<QString, int> &nameIdx = pageNameIndex();
+    QBitArray restored(pages.size());
+    QString name;
 
     for(int i = 0; i < size; i++)
     {
-        QString name;
         bool visible;
 
-        stream >> name;
+        if(!readStateString(stream, name))
+            return false;
         stream >> visible;
 
-        order.append(name);
-        visibility.append(visible);
+        if(stream.status() != QDataStream::Ok)
+            return false;
+
+        int idx = nameIdx.value(name, -1);
+        if((idx >= 0) && !restored.testBit(idx))
+        {
+            restored.setBit(idx);
+            saved.pageList.append(qMakePair(idx, visible));
+        }
+
+        if(i == cur)
+            saved.current = idx;
     }
 
-    foreach(const QString &name, order)
-    {
-        bool found = false;
+    saved.rows          = rows;
+    saved.collapsed     = colstate;
+    saved.expandedWidth = expwidth;
 
-        for(int i = 0; i < pages.size(); i++)
-            if(name == pages[i].name())
-                found = true;
+    return true;
+}
 
-        if(!found)
-            return false;
+void NavBar::applyState(const SavedState &saved)
+{
+    QList<NavBarPage> sortedPages;
+    QVector<int> newIndex(pages.size(), -1);
+    sortedPages.reserve(pages.size());
+
+    for(int i = 0; i < saved.pageList.size(); i++)
+    {
+        int idx = saved.pageList[i].first;
+        newIndex[idx] = sortedPages.size();
+        sortedPages.append(pages[idx]);
+        sortedPages.last().setVisible(saved.pageList[i].second);
     }
 
-    pages = sortNavBarPageList(pages, order);
-    for(int i = 0; i < visibility.size(); i++)
-        pages[i].setVisible(visibility[i]);
+    for(int i = 0; i < pages.size(); i++)
+    {
+        if(newIndex[i] < 0)
+        {
+            newIndex[i] = sortedPages.size();
+            sortedPages.append(pages[i]);
+        }
+    }
 
-    recalcPageList(true);
-    refillToolBar(visibleRows());
-    refillPagesMenu();
+    pages = sortedPages;
+    applyPageOrder();
 
-    setVisibleRows(rows);
-    setCurrentIndex(cur);
-    setCollapsed(colstate);
-    header->button->setChecked(colstate);
+    setVisibleRows(saved.rows);
+    if(saved.current >= 0)
+        setCurrentIndex(newIndex[saved.current]);
 
-    contentsPopup->resize(0, 0);
-    if(collapsedState)
-        expandedWidth = expwidth;
+    // children of groups, which were expanded, are created later, when event loop is idle
+    foreach(const SavedState::Group &group, saved.groups)
+    {
+        int idx = newIndex[group.page];
+        pageGroups.value(pages[idx].action)->setCurrentChild(group.child);
 
-    return true;
+        if(group.expanded)
+            enqueuePreload(pageHost(idx));
+    }
+
+    if(!preloadQueue.isEmpty())
+        preloadTimer->start();
+
+    // restored state is applied without animation, which would overwrite saved expanded width when finished
+    if(collapseTimeLine->state() == QTimeLine::Running)
+        finishCollapseAnimation();
+    if(saved.collapsed != collapsedState)
+        applyCollapsed(saved.collapsed);
+    header->button->setChecked(saved.collapsed);
+
+    contentsPopup->resize(0, 0);
+    if(collapsedState && (saved.expandedWidth > 0))
+        expandedWidth = saved.expandedWidth;
 }
 
 QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStringList &order)
+{
+    QHash<QString, int> nameIndex;
+    nameIndex.reserve(pages.size());
+
+    for(int i = 0; i < pages.size(); i++)
+        nameIndex.insert(pages[i].name(), i);
+
+    return sortNavBarPageList(pages, order, nameIndex);
+}
+
+/*
+ * nameIndex must map names of pages to their positions in pages list.
+ */
+QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStringList &order, const QHash<QString, int> &nameIndex)
 {
     QList<NavBarPage> sortedPages;
+    sortedPages.reserve(order.size());
 
     for(int i = 0; i < order.size(); i++)
     {
-        int idx = -1;
-
-        for(int j = 0; j < pages.size(); j++)
-        {
-            if(order[i] == pages[j].name())
-            {
-                idx = j;
-                break;
-            }
-        }
+        int idx = nameIndex.value(order[i], -1);
 
         if(idx >= 0)
             sortedPages.append(pages[idx]);
@@ -1045,6 +3504,14 @@ QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStri
 }
 
 
+typedef QHash<QString, QString> NavBarStyleCache;
+Q_GLOBAL_STATIC(NavBarStyleCache, styleCache)
+Q_GLOBAL_STATIC(QString, appliedStyle)
+
+// applied style sheet is enclosed in these comments, so it is found even if application style sheet was changed since
+static const char appStyleBegin[] = "/* NavBar::setApplicationStyle() begin */\n";
+static const char appStyleEnd[]   = "\n/* NavBar::setApplicationStyle() end */\n";
+
 /**
  * Helper function, which loads text file and returns it content as QString.
  * There are some style sheets, included in resources under <tt>:/styles/</tt> path:
@@ -1065,24 +3532,148 @@ QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStri
  * you should call <TT>Q_INIT_RESOURCE(navbar)</TT> in your application, see
  * <A HREF="http://qt-project.org/doc/qt-4.8/qdir.html#Q_INIT_RESOURCE">Q_INIT_RESOURCE</A>.
  *
+ * Loaded files are cached, so each file is read only once, see clearStyleCache().
+ *
  * @param filename Style sheet file name
  * @return Style sheet
  */
 QString NavBar::loadStyle(const QString &filename)
 {
+    NavBarStyleCache *cache = styleCache();
+
+    NavBarStyleCache::const_iterator it = cache->constFind(filename);
+    if(it != cache->constEnd())
+        return it.value();
+
     QFile stylefile(filename);
     if(stylefile.open(QFile::ReadOnly))
     {
         QTextStream stream(&stylefile);
         QString stylesheet = stream.readAll();
+        cache->insert(filename, stylesheet);
         return stylesheet;
     }
     else
         return "";
 }
 
+/**
+ * Clears the cache of style sheets, loaded by loadStyle().
+ * Call it, if style sheet files were changed on disk.
+ */
+void NavBar::clearStyleCache()
+{
+    styleCache()->clear();
+}
+
+/**
+ * Applies style sheet to all navigation bars in application.
+ * Style sheet is appended to application style sheet, replacing the one, applied by previous call,
+ * so Qt parses it once for all navigation bars and their popups, instead of once per widget.
+ * Applied style sheet is enclosed in comments, which must be kept if application style sheet is changed elsewhere.
+ * Pass empty string to remove navigation bar style sheet from application.
+ *
+ * @par Example:
+ * @code
+   NavBar::setApplicationStyle(NavBar::loadStyle(":/styles/office2007blue.css"));
+   @endcode
+ *
+ * @param styleSheet Style sheet
+ */
+void NavBar::setApplicationStyle(const QString &styleSheet)
+{
+    QString appStyle = qApp->styleSheet();
+    QString block;
+    if(!styleSheet.isEmpty())
+        block = QLatin1String(appStyleBegin) + styleSheet + QLatin1String(appStyleEnd);
+
+    int begin = appStyle.indexOf(QLatin1String(appStyleBegin));
+    int end   = (begin >= 0) ? appStyle.indexOf(QLatin1String(appStyleEnd), begin) : -1;
+
+    if(end >= 0)
+        appStyle.replace(begin, end + int(sizeof(appStyleEnd)) - 1 - begin, block);
+    else
+        appStyle += block;
+
+    *appliedStyle() = styleSheet;
+
+    if(appStyle != qApp->styleSheet())
+        qApp->setStyleSheet(appStyle);
+}
+
+/**
+ * Returns style sheet, applied by setApplicationStyle().
+ * @return Style sheet
+ */
+QString NavBar::applicationStyle()
+{
+    return *appliedStyle();
+}
+
 
 NavBarToolBar::NavBarToolBar(QWidget *parent):
     QToolBar(parent)
 {
+    navBarTheme = 0;
+}
+
+void NavBarToolBar::setTheme(const NavBarTheme *theme)
+{
+    navBarTheme = theme;
+    update();
+}
+
+void NavBarToolBar::paintEvent(QPaintEvent *e)
+{
+    if(!navBarTheme)
+    {
+        QToolBar::paintEvent(e);
+        return;
+    }
+
+    QPainter p(this);
+    navBarTheme->toolBarFill.paint(&p, rect());
+    p.setPen(navBarTheme->borderColor);
+    p.drawLine(0, 0, width()-1, 0);
+}
+
+/* Buttons are created by toolbar, so badges are painted over them by overlay widgets */
+void NavBarToolBar::actionEvent(QActionEvent *e)
+{
+    QToolBar::actionEvent(e);
+
+    if(e->type() == QEvent::ActionAdded)
+        updateBadge(e->action());
+}
+
+/*
+ * Creates badge overlay on the button of given action, when the action gets badge for the first time.
+ * Buttons without badges have no overlay.
+ */
+void NavBarToolBar::updateBadge(QAction *action)
+{
+    QToolButton *button = qobject_cast<QToolButton *>(widgetForAction(action));
+
+    if(button && !action->property("navBarBadge").toString().isEmpty() && !button->findChild<NavBarBadgeOverlay *>())
+        new NavBarBadgeOverlay(button);
 }
+
+
+/**
+ * @class NavBarUpdateLocker
+ * @brief Convenience class, which calls NavBar::beginUpdate() in constructor and NavBar::endUpdate() in destructor.
+ *
+ * @par Example:
+ * @code
+   {
+       NavBarUpdateLocker locker(navBar);
+       navBar->addPage(new QLabel("Page 1 contents"), "Page 1");
+       navBar->addPage(new QLabel("Page 2 contents"), "Page 2");
+   } // navBar is updated here
+   @endcode
+ */
+
+/**
+ * @struct NavBarPageInfo
+ * @brief Page description, used by NavBar::addPages().
+ */
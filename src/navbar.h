@@ -2,15 +2,29 @@
 #define NAVBAR_H
 
 #include <QStackedWidget>
+#include <QStackedLayout>
 #include <QToolBar>
 #include <QList>
+#include <QVector>
 #include <QActionGroup>
 #include <QMenu>
 #include <QByteArray>
+#include <QDataStream>
+#include <QTimer>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QTimeLine>
+#include <QLabel>
+#include <QKeySequence>
+#include <QAbstractItemModel>
 #include "navbarpage.h"
+#include "navbartheme.h"
+#include "navbarstats.h"
 #include "navbarheader.h"
 #include "navbarsplitter.h"
 #include "navbarpagelistwidget.h"
+#include "navbarquickfilter.h"
+#include "navbargroup.h"
 
 
 class NavBarToolBar: public QToolBar
@@ -19,6 +33,26 @@ class NavBarToolBar: public QToolBar
 
 public:
     explicit NavBarToolBar(QWidget *parent = 0);
+
+    void setTheme(const NavBarTheme *theme);
+    void updateBadge(QAction *action);
+
+protected:
+    void paintEvent(QPaintEvent *e);
+    void actionEvent(QActionEvent *e);
+
+private:
+    const NavBarTheme *navBarTheme;
+};
+
+struct NavBarPageInfo
+{
+    NavBarPageInfo(QWidget *w = 0, const QString &t = QString(), const QIcon &i = QIcon()):
+        widget(w), text(t), icon(i) {}
+
+    QWidget *widget;
+    QString  text;
+    QIcon    icon;
 };
 
 class NavBar : public QFrame
@@ -35,8 +69,31 @@ class NavBar : public QFrame
     Q_PROPERTY(int   visibleRows        READ visibleRows        WRITE setVisibleRows  NOTIFY visibleRowsChanged)
     Q_PROPERTY(QSize smallIconSize      READ smallIconSize      WRITE setSmallIconSize)
     Q_PROPERTY(QSize largeIconSize      READ largeIconSize      WRITE setLargeIconSize)
+    Q_PROPERTY(int   maxLoadedPages     READ maxLoadedPages     WRITE setMaxLoadedPages)
+    Q_PROPERTY(int   pageUnloadTimeout  READ pageUnloadTimeout  WRITE setPageUnloadTimeout)
+    Q_PROPERTY(PreloadMode preloadMode  READ preloadMode        WRITE setPreloadMode)
+    Q_PROPERTY(int   preloadCount       READ preloadCount       WRITE setPreloadCount)
+    Q_PROPERTY(int   preloadSliceTime   READ preloadSliceTime   WRITE setPreloadSliceTime)
+    Q_PROPERTY(bool  virtualPageList    READ isVirtualPageList  WRITE setVirtualPageList)
+    Q_PROPERTY(int   collapseDuration   READ collapseDuration   WRITE setCollapseDuration)
+    Q_PROPERTY(bool  statsEnabled       READ isStatsEnabled     WRITE setStatsEnabled)
+    Q_PROPERTY(QKeySequence quickFilterShortcut READ quickFilterShortcut WRITE setQuickFilterShortcut)
+    Q_ENUMS(PreloadMode)
 
 public:
+    enum PreloadMode
+    {
+        NoPreload,
+        PreloadAdjacent,
+        PreloadRecent
+    };
+
+    enum PageDataRole
+    {
+        PageFactoryRole = Qt::UserRole + 1000,
+        PageNameRole
+    };
+
     explicit NavBar(QWidget *parent = 0, Qt::WindowFlags f = 0);
     ~NavBar();
 
@@ -47,14 +104,44 @@ public:
     int      insertPage(int index, QWidget *page, const QString &text);
     int      insertPage(int index, QWidget *page, const QString &text, const QIcon &icon);
 
+    int      addPage(NavBarPageFactory *factory, const QString &text);
+    int      addPage(NavBarPageFactory *factory, const QString &text, const QIcon &icon);
+    int      insertPage(int index, NavBarPageFactory *factory, const QString &text);
+    int      insertPage(int index, NavBarPageFactory *factory, const QString &text, const QIcon &icon);
+
+    int      addPages(const QList<NavBarPageInfo> &pageList);
+
+    int      addGroup(NavBarGroupFactory *factory, const QString &text);
+    int      addGroup(NavBarGroupFactory *factory, const QString &text, const QIcon &icon);
+    int      insertGroup(int index, NavBarGroupFactory *factory, const QString &text);
+    int      insertGroup(int index, NavBarGroupFactory *factory, const QString &text, const QIcon &icon);
+    bool     isGroup(int index) const;
+    int      currentChild(int index) const;
+    void     setCurrentChild(int index, int child);
+
+    void     setModel(QAbstractItemModel *model);
+    QAbstractItemModel *model() const;
+
     void     removePage(int index);
 
+    void     beginUpdate();
+    void     endUpdate();
+    bool     isUpdating() const;
+
     void     setPageText(int index, const QString &text);
     QString  pageText(int index) const;
 
+    void     setPageName(int index, const QString &name);
+    QString  pageName(int index) const;
+    int      indexOfPage(const QString &name) const;
+
     void     setPageIcon(int index, const QIcon &icon);
     QIcon    pageIcon(int index) const;
 
+    void     setPageBadge(int index, const QString &badge);
+    void     setPageBadge(int index, int count);
+    QString  pageBadge(int index) const;
+
     void     setPageEnabled(int index, bool enabled);
     bool     isPageEnabled(int index);
 
@@ -65,6 +152,23 @@ public:
     QWidget *currentWidget() const;
     QWidget *widget(int index) const;
     int      indexOf(QWidget *widget) const;
+    bool     isPageCreated(int index) const;
+    bool     unloadPage(int index);
+
+    void     setMaxLoadedPages(int count);
+    int      maxLoadedPages() const;
+
+    void     setPageUnloadTimeout(int msec);
+    int      pageUnloadTimeout() const;
+
+    void     setPreloadMode(PreloadMode mode);
+    PreloadMode preloadMode() const;
+
+    void     setPreloadCount(int count);
+    int      preloadCount() const;
+
+    void     setPreloadSliceTime(int msec);
+    int      preloadSliceTime() const;
     int      count() const;
 
     void     setSmallIconSize(const QSize &size);
@@ -73,6 +177,20 @@ public:
     void     setLargeIconSize(const QSize &size);
     QSize    largeIconSize() const;
 
+    void     setVirtualPageList(bool enable);
+    bool     isVirtualPageList() const;
+
+    void     setCollapseDuration(int msec);
+    int      collapseDuration() const;
+
+    void        setStatsEnabled(bool enable);
+    bool        isStatsEnabled() const;
+    NavBarStats stats() const;
+    void        resetStats();
+
+    void         setQuickFilterShortcut(const QKeySequence &shortcut);
+    QKeySequence quickFilterShortcut() const;
+
     int      rowHeight() const;
     bool     isCollapsed() const;
     bool     autoPopup() const;
@@ -82,16 +200,28 @@ public:
     int      visibleRows() const;
 
     QByteArray saveState(int version = 0) const;
+    bool       saveState(QIODevice *device, int version = 0) const;
+    int        stateSize() const;
     bool       restoreState(const QByteArray & state, int version = 0);
+    bool       restoreState(QIODevice *device, int version = 0);
 
     QSize    sizeHint() const;
 
+    void        setTheme(const NavBarTheme &theme);
+    NavBarTheme theme() const;
+
     static QString loadStyle(const QString &filename);
+    static void    clearStyleCache();
+    static void    setApplicationStyle(const QString &styleSheet);
+    static QString applicationStyle();
 
 signals:
     void currentChanged(int index);
     void visibleRowsChanged(int rows);
     void collapsedChanged(bool collapsed);
+    void pageCreated(int index);
+    void pageUnloaded(int index);
+    void currentChildChanged(int index, int child);
 
 public slots:
     void setCurrentIndex(int index);
@@ -104,40 +234,120 @@ public slots:
     void setShowOptionsMenu(bool show);
     void setVisibleRows(int rows);
     int  showOptionsDialog();
+    void showQuickFilter();
 
 protected:
     void resizeEvent(QResizeEvent *e);
     void changeEvent(QEvent *e);
+    void paintEvent(QPaintEvent *e);
 
 private slots:
     void onClickPageButton(QAction *action);
     void onButtonVisibilityChanged(int visCount);
     void changePageVisibility(QAction *action);
     void showContentsPopup();
+    void unloadExpiredPages();
+    void preloadPages();
+    void updatePageIcons();
+    void updatePageBadges();
+    void onPageActionChanged();
+    void updatePagesMenu();
+    void updateOverflowMenu();
+    void animateCollapse(qreal value);
+    void finishCollapseAnimation();
+    void onQuickFilterActivated(QAction *action);
+    void onGroupChildChanged(int child);
+    void onModelRowsInserted(const QModelIndex &parent, int first, int last);
+    void onModelRowsRemoved(const QModelIndex &parent, int first, int last);
+    void onModelRowsMoved(const QModelIndex &parent, int start, int end, const QModelIndex &destination, int row);
+    void onModelDataChanged(const QModelIndex &topLeft, const QModelIndex &bottomRight, const QVector<int> &roles = QVector<int>());
+    void onModelReset();
+    void onModelLayoutAboutToBeChanged();
+    void onModelLayoutChanged();
+    void onModelDestroyed();
 
 private:
     void resizeContent(const QSize &size, int rowheight);
     void reorderStackedWidget();
-    void recalcPageList(bool reorder);
+    void insertPageSlot(int index, int slot);
+    void removePageSlot(int index);
+    void rebuildSlotPages() const;
+    int  indexOfSlot(int slot) const;
+    void recalcPageList();
     void refillToolBar(int visCount);
     void refillPagesMenu();
+    QAction *createPageMenuAction(int index);
+    void addToPageLists(int index);
+    void removeFromPageLists(int index);
     void moveContentsToPopup(bool popup);
     void setHeaderText(const QString &text);
+    void updatePageToolTip(int index);
+    NavBarPageHost *pageHost(int index) const;
+    void activatePage(int index);
+    void applyPageLimit();
+    bool unloadHost(NavBarPageHost *host);
+    void schedulePreload(int index);
+    void enqueuePreload(NavBarPageHost *host);
+    const NavBarTheme *activeTheme() const;
+    void scheduleIconUpdate();
+    QIcon renderIcon(const QIcon &source) const;
+    void retainIcon(const QIcon &source);
+    void releaseIcon(const QIcon &source);
+    QToolButton *createPageButton();
+    QList<QToolButton *> pageButtons() const;
+    int  toolBarCapacity() const;
+    void applyCollapsed(bool collapse);
+    void startCollapseAnimation(bool collapse);
+    QPixmap grabSnapshot();
+    NavBarStats *collectStats() const;
+    int  indexOfAction(QAction *action) const;
+    void removePageAt(int index);
+    void renamePage(int index, int orderIdx, const QString &name);
+    void insertModelRows(int first, int last);
+    void removeModelRows(int first, int last);
 
-    QList<NavBarPage> visiblePages();
+    const QList<NavBarPage> &visiblePages() const;
+    void invalidatePageList();
+    void renumberPages(int from);
+    void applyPageOrder();
+    const QHash<QString, int> &pageNameIndex() const;
 
-    NavBarHeader         *header;
+    struct SavedState;
+    bool parseState(QIODevice *device, int version, SavedState &saved) const;
+    bool readState(QDataStream &stream, int version, SavedState &saved) const;
+    bool readLegacyState(QDataStream &stream, int version, SavedState &saved) const;
+    void applyState(const SavedState &saved);
+
+    NavBarHeader        *header;
     QStackedWidget       *stackedWidget;
+    QStackedLayout       *contentSlot;
     NavBarSplitter       *splitter;
     NavBarPageListWidget *pageListWidget;
     NavBarToolBar        *pageToolBar;
     QActionGroup         *actionGroup;
     QMenu                *pagesMenu;
+    QMenu                *overflowMenu;
     QFrame               *contentsPopup;
     NavBarTitleButton    *pageTitleButton;
     QAction              *actionOptions;
+    QAction              *spacerAction;
+    QAction              *overflowAction;
+    QAction              *menuButtonAction;
     QList<NavBarPage>     pages;
     QStringList           pageOrder;
+    QVector<int>          pageSlots; // page index -> position of page widget in stackedWidget
+    mutable QVector<int>  slotPages; // position in stackedWidget -> page index
+    mutable bool          slotPagesValid;
+    NavBarTheme           paintTheme;
+
+    mutable QList<NavBarPage> visiblePageList;
+    mutable bool              visiblePageListValid;
+    mutable QHash<QString, int> nameIndex;
+    mutable bool              nameIndexValid;
+    bool                      toolBarValid;
+    int                       toolBarRows;
+    int                       overflowFirst;
+    int                       relayoutFrom; // first row of page list, which buttons may be out of place
 
     bool  collapsedState;
     bool  autoPopupMode;
@@ -149,10 +359,77 @@ private:
     QSize pageIconSize;
     int   uniquePageCount;
     bool  proceedCollapse;
+    int   updateLevel;
+    bool  updatePending;
+    int   updateRows;
+    int   updateCurrentIndex;
 
-    enum { NavBarMarker = 0x4e427232 };
+    NavBarPageHost        *activeHost;
+    QList<NavBarPageHost*> loadedHosts;
+    QElapsedTimer          pageClock;
+    QTimer                *unloadTimer;
+    int                    maxLoaded;
+    int                    unloadTimeout;
+    QList<NavBarPageHost*> recentHosts;
+    QList<NavBarPageHost*> preloadQueue;
+    QTimer                *preloadTimer;
+    PreloadMode            preload;
+    int                    preloadLimit;
+    int                    preloadSlice;
+    QHash<qint64, QIcon>   iconCache; // source icon -> pre-rendered icon
+    QHash<qint64, int>     iconRefs;  // source icon -> number of pages using it
+    QTimer                *iconTimer;
+    int                    iconScanPos;
+    QSet<QAction*>         badgeQueue;
+    QTimer                *badgeTimer;
+    bool                   pagesMenuValid;
+    QHash<QAction*, QAction*> pageMenuActions; // page action -> its entry in pages menu
+    bool                   virtualList;
+    bool                   contentsInPopup;
+
+    QLabel                *collapseOverlay;
+    QTimeLine             *collapseTimeLine;
+    QPixmap                expandedSnapshot;
+    int                    animDuration;
+    bool                   animCollapse;
+    int                    animStartWidth;
+    int                    animEndWidth;
+    bool                   animHeaderHidden;
+
+    mutable NavBarStats    perfStats;
+    bool                   statsEnabled;
+
+    NavBarSearchIndex      searchIndex;
+    NavBarQuickFilter     *quickFilter;
+    QAction               *actionQuickFilter;
+    QHash<QAction *, NavBarGroup *> pageGroups; // page action -> group, for pages added with addGroup()
+    QAbstractItemModel    *pageModel;
+    QList<QAction *>       modelActions; // model row -> page action
+    QList<QPersistentModelIndex> layoutIndexes; // model rows before layout change
+
+    enum { NavBarMarker = 0x4e427232, NavBarStateMarker = 0x4e427233, NavBarStateFormat = 2, NavBarStateHeaderSize = 16 };
+    enum StateTag
+    {
+        VisibleRowsTag = 1,
+        CurrentPageTag,
+        CollapsedTag,
+        ExpandedWidthTag,
+        PagesTag,
+        GroupsTag
+    };
 
     friend class NavBarPageListWidget;
 };
 
+class NavBarUpdateLocker
+{
+public:
+    inline explicit NavBarUpdateLocker(NavBar *navBar): nb(navBar) { nb->beginUpdate(); }
+    inline ~NavBarUpdateLocker()                                   { nb->endUpdate();   }
+
+private:
+    Q_DISABLE_COPY(NavBarUpdateLocker)
+    NavBar *nb;
+};
+
 #endif // NAVBAR_H
@@ -0,0 +1,146 @@
+#include "navbargroup.h"
+
+/**
+ * @class NavBarGroupFactory
+ * @brief Interface for children of navigation bar page groups.
+ *
+ * Group is a page, which content is a list of child entries, e.g. mail folders. Children are created
+ * only when the group is opened for the first time, so large hierarchies cost nothing until they are used.
+ * Navigation bar takes ownership of the factory.
+ * @par Example:
+ * @code
+   class FolderFactory: public NavBarGroupFactory
+   {
+   public:
+       QList<NavBarGroupItem> createChildren()
+       {
+           QList<NavBarGroupItem> folders;
+           foreach(const Folder &f, mailbox->folders())
+               folders.append(NavBarGroupItem(f.name, f.icon, f.id));
+           return folders;
+       }
+   };
+
+   navBar->addGroup(new FolderFactory, "Mail", QIcon(":/images/mail.png"));
+   @endcode
+ * @sa NavBar::addGroup(), NavBar::currentChildChanged()
+ */
+/**
+ * @fn NavBarGroupFactory::createChildren
+ * Creates child entries of the group.
+ * @return Child entries
+ */
+
+/**
+ * @struct NavBarGroupItem
+ * @brief Child entry of navigation bar page group.
+ */
+
+/**
+ * @class NavBarGroup
+ * @brief Page factory of page group, used internally by NavBar.
+ *
+ * Creates list of child entries as page widget, and keeps current child while the list is unloaded.
+ */
+
+/**
+ * Constructs new group.
+ * @param factory Children factory, group takes ownership of it
+ * @param parent Parent object
+ */
+NavBarGroup::NavBarGroup(NavBarGroupFactory *factory, QObject *parent):
+    QObject(parent)
+{
+    groupFactory = factory;
+    list         = 0;
+    current      = -1;
+}
+
+NavBarGroup::~NavBarGroup()
+{
+    delete groupFactory;
+}
+
+/**
+ * Creates list of child entries.
+ * @return List widget
+ */
+QWidget *NavBarGroup::createPage()
+{
+    list = new QListWidget;
+    list->setObjectName("navBarGroupList"); //for stylesheets
+    list->setFrameStyle(QFrame::NoFrame);
+    list->setUniformItemSizes(true);
+
+    if(groupFactory)
+    {
+        foreach(const NavBarGroupItem &child, groupFactory->createChildren())
+        {
+            QListWidgetItem *item = new QListWidgetItem(child.icon, child.text, list);
+            item->setData(Qt::UserRole, child.data);
+        }
+    }
+
+    if(current >= list->count())
+        current = -1;
+
+    list->setCurrentRow(current);
+    connect(list, SIGNAL(currentRowChanged(int)), SLOT(onCurrentRowChanged(int)));
+
+    return list;
+}
+
+/**
+ * Deletes list of child entries, current child is kept.
+ * @param page List widget
+ */
+void NavBarGroup::releasePage(QWidget *page)
+{
+    if(page == list)
+        list = 0;
+
+    delete page;
+}
+
+/**
+ * Returns list of child entries, or 0 if the group is not expanded.
+ * @return List widget
+ */
+QListWidget *NavBarGroup::childList() const
+{
+    return list;
+}
+
+/**
+ * Returns index of current child entry, or -1 if there is no current child.
+ * @return Child index
+ */
+int NavBarGroup::currentChild() const
+{
+    return current;
+}
+
+/**
+ * Sets current child entry. If the group is not expanded yet, child is selected when it is expanded.
+ * @param child Child index
+ */
+void NavBarGroup::setCurrentChild(int child)
+{
+    if(list)
+    {
+        list->setCurrentRow(child);
+        return;
+    }
+
+    if(child != current)
+    {
+        current = child;
+        emit currentChildChanged(child);
+    }
+}
+
+void NavBarGroup::onCurrentRowChanged(int row)
+{
+    current = row;
+    emit currentChildChanged(row);
+}
@@ -0,0 +1,52 @@
+#ifndef NAVBARGROUP_H
+#define NAVBARGROUP_H
+
+#include <QListWidget>
+#include <QVariant>
+#include "navbarpage.h"
+
+struct NavBarGroupItem
+{
+    NavBarGroupItem(const QString &t = QString(), const QIcon &i = QIcon(), const QVariant &d = QVariant()):
+        text(t), icon(i), data(d) {}
+
+    QString  text;
+    QIcon    icon;
+    QVariant data;
+};
+
+class NavBarGroupFactory
+{
+public:
+    virtual ~NavBarGroupFactory() {}
+    virtual QList<NavBarGroupItem> createChildren() = 0;
+};
+
+class NavBarGroup : public QObject, public NavBarPageFactory
+{
+    Q_OBJECT
+
+public:
+    explicit NavBarGroup(NavBarGroupFactory *factory, QObject *parent = 0);
+    ~NavBarGroup();
+
+    QWidget *createPage();
+    void     releasePage(QWidget *page);
+
+    QListWidget *childList() const;
+    int          currentChild() const;
+    void         setCurrentChild(int child);
+
+signals:
+    void currentChildChanged(int child);
+
+private slots:
+    void onCurrentRowChanged(int row);
+
+private:
+    NavBarGroupFactory *groupFactory;
+    QListWidget        *list;
+    int                 current;
+};
+
+#endif // NAVBARGROUP_H
@@ -1,6 +1,7 @@
 ﻿#include <QStylePainter>
 #include <QStyleOptionButton>
 #include <QFontMetrics>
+#include <QPainter>
 #include "navbarheader.h"
 
 
@@ -28,6 +29,7 @@
 NavBarHeader::NavBarHeader(QWidget *parent, Qt::WindowFlags f):
     QLabel(parent, f)
 {
+    navBarTheme = 0;
     createButton();
 }
 
@@ -40,6 +42,7 @@ NavBarHeader::NavBarHeader(QWidget *parent, Qt::WindowFlags f):
 NavBarHeader::NavBarHeader(const QString &text, QWidget *parent, Qt::WindowFlags f):
     QLabel(text, parent, f)
 {
+    navBarTheme = 0;
     createButton();
 }
 
@@ -49,6 +52,52 @@ void NavBarHeader::resizeEvent(QResizeEvent *e)
     QLabel::resizeEvent(e);
 }
 
+/**
+ * Sets theme, used for painting. If theme is 0, header is painted by style (and style sheet).
+ * @param theme Theme, owned by navigation bar
+ */
+void NavBarHeader::setTheme(const NavBarTheme *theme)
+{
+    navBarTheme = theme;
+
+    if(theme)
+    {
+        QPalette pal = button->palette();
+        pal.setColor(QPalette::ButtonText, theme->headerTextColor);
+        button->setPalette(pal);
+    }
+    else
+        button->setPalette(QPalette());
+
+    update();
+}
+
+void NavBarHeader::paintEvent(QPaintEvent *e)
+{
+    if(!navBarTheme)
+    {
+        QLabel::paintEvent(e);
+        return;
+    }
+
+    QPainter p(this);
+    navBarTheme->headerFill.paint(&p, rect());
+
+    if(navBarTheme->headerLineColor.isValid())
+    {
+        p.setPen(navBarTheme->headerLineColor);
+        p.drawLine(0, 0, width()-1, 0);
+    }
+
+    QFont f = font();
+    f.setBold(true);
+    p.setFont(f);
+    p.setPen(navBarTheme->headerTextColor);
+
+    QRect textRect(3, 0, button->x() - 3, height());
+    p.drawText(textRect, Qt::AlignLeft | Qt::AlignVCenter, QFontMetrics(f).elidedText(text(), Qt::ElideRight, textRect.width()));
+}
+
 void NavBarHeader::createButton()
 {
     button = new QToolButton(this);
@@ -67,7 +116,10 @@ void NavBarHeader::createButton()
 NavBarTitleButton::NavBarTitleButton(QWidget *parent):
     QPushButton(parent)
 {
-
+    navBarTheme  = 0;
+    cachedColor  = 0;
+    cachedHeight = -1;
+    cachedRatio  = 1.0;
 }
 
 QSize NavBarTitleButton::sizeHint() const
@@ -80,19 +132,102 @@ QSize NavBarTitleButton::minimumSizeHint() const
     return QSize(-1, -1);
 }
 
+/**
+ * Sets theme, used for painting. If theme is 0, button is painted by style (and style sheet).
+ * @param theme Theme, owned by navigation bar
+ */
+void NavBarTitleButton::setTheme(const NavBarTheme *theme)
+{
+    navBarTheme = theme;
+    setAttribute(Qt::WA_Hover, true);
+    update();
+}
+
 void NavBarTitleButton::paintEvent(QPaintEvent *e)
 {
     Q_UNUSED(e);
 
     QStylePainter p(this);
-    QStyleOptionButton opt;
-    initStyleOption(&opt);
 
-    p.drawControl(QStyle::CE_PushButtonBevel, opt);
+    if(navBarTheme)
+    {
+        NavBarTheme::ButtonState state = isDown() ? NavBarTheme::Pressed : (underMouse() ? NavBarTheme::Hover : NavBarTheme::Normal);
+        p.fillRect(rect(), navBarTheme->titleColor[state]);
+
+        if(state == NavBarTheme::Normal)
+        {
+            p.setPen(Qt::white);
+            p.drawLine(0, 0, width()-1, 0);
+            p.drawLine(0, 0, 0, height()-1);
+        }
+
+        QFont f = font();
+        f.setBold(true);
+        p.setFont(f);
+        p.setPen(navBarTheme->titleTextColor);
+    }
+    else
+    {
+        QStyleOptionButton opt;
+        initStyleOption(&opt);
+
+        p.drawControl(QStyle::CE_PushButtonBevel, opt);
+        p.setFont(font());
+    }
 
-    p.setFont(font());
-    QFontMetrics fm(font());
-    p.translate(width()/2 + fm.ascent()/2, height()/2 + fm.width(text())/2);
+    const QPixmap &title = titlePixmap(p.font(), p.pen().color());
+    if(title.isNull())
+        return;
+
+    QSize titleSize = title.size() / cachedRatio;
+    p.drawPixmap((width() - titleSize.width()) / 2, (height() - titleSize.height()) / 2, title);
+}
+
+/*
+ * Returns title text, rotated and elided to fit button height.
+ * Text is rendered only when text, font, color, height or device pixel ratio changes,
+ * so resizing and hovering collapsed navigation bar does not measure and draw text every time.
+ */
+const QPixmap &NavBarTitleButton::titlePixmap(const QFont &font, const QColor &color)
+{
+#if QT_VERSION >= 0x050600
+    qreal ratio = devicePixelRatioF();
+#else
+    qreal ratio = 1.0;
+#endif
+
+    if((cachedHeight == height()) && (cachedRatio == ratio) && (cachedColor == color.rgba()) &&
+       (cachedText == text()) && (cachedFont == font))
+        return cachedPixmap;
+
+    cachedText   = text();
+    cachedFont   = font;
+    cachedColor  = color.rgba();
+    cachedHeight = height();
+    cachedRatio  = ratio;
+
+    QFontMetrics fm(font);
+    QString title = fm.elidedText(cachedText, Qt::ElideRight, cachedHeight - 8);
+    int titleWidth = fm.width(title);
+
+    if(title.isEmpty() || (titleWidth <= 0))
+    {
+        cachedPixmap = QPixmap();
+        return cachedPixmap;
+    }
+
+    cachedPixmap = QPixmap(qRound(fm.height() * ratio), qRound(titleWidth * ratio));
+    cachedPixmap.fill(Qt::transparent);
+#if QT_VERSION >= 0x050600
+    cachedPixmap.setDevicePixelRatio(ratio);
+#endif
+
+    QPainter p(&cachedPixmap);
+    p.setFont(font);
+    p.setPen(color);
+    p.translate(fm.ascent(), titleWidth);
     p.rotate(270);
-    p.drawText(0, 0, text());
+    p.drawText(0, 0, title);
+
+    return cachedPixmap;
 }
@@ -6,6 +6,7 @@
 #include <QPushButton>
 #include <QResizeEvent>
 #include <QPaintEvent>
+#include "navbartheme.h"
 
 
 class NavBarHeader: public QLabel
@@ -18,14 +19,19 @@ public:
 
     QToolButton *button;
 
+    void setTheme(const NavBarTheme *theme);
+
 signals:
     void buttonClicked(bool checked = false);
 
 protected:
     void resizeEvent(QResizeEvent *e);
+    void paintEvent(QPaintEvent *e);
 
 private:
     void createButton();
+
+    const NavBarTheme *navBarTheme;
 };
 
 class NavBarTitleButton: public QPushButton
@@ -38,8 +44,22 @@ public:
     QSize sizeHint() const;
     QSize minimumSizeHint() const;
 
+    void setTheme(const NavBarTheme *theme);
+
 protected:
     void paintEvent(QPaintEvent *e);
+
+private:
+    const QPixmap &titlePixmap(const QFont &font, const QColor &color);
+
+    const NavBarTheme *navBarTheme;
+
+    QPixmap cachedPixmap; // rotated title, rendered for parameters below
+    QString cachedText;
+    QFont   cachedFont;
+    QRgb    cachedColor;
+    int     cachedHeight;
+    qreal   cachedRatio;
 };
 
 #endif // NAVBARHEADER_H
@@ -0,0 +1,152 @@
+#include <QVBoxLayout>
+#include "navbarpage.h"
+
+/**
+ * @class NavBarPageFactory
+ * @brief Interface for lazily created navigation bar pages.
+ *
+ * Reimplement createPage() and pass factory instance to NavBar::addPage(). Page widget will be created
+ * on first selection of the page. Navigation bar takes ownership of the factory.
+ * @par Example:
+ * @code
+   class ReportPageFactory: public NavBarPageFactory
+   {
+   public:
+       QWidget *createPage() { return new ReportView(database); }
+   };
+
+   navBar->addPage(new ReportPageFactory, "Reports", QIcon(":/images/report.png"));
+   navBar->addPage(new NavBarTypedPageFactory<CalendarView>, "Calendar", QIcon(":/images/calendar.png"));
+   @endcode
+ */
+/**
+ * @fn NavBarPageFactory::createPage
+ * Creates page widget.
+ * @return New page widget
+ */
+/**
+ * @fn NavBarPageFactory::releasePage
+ * Called when navigation bar unloads inactive page (see NavBar::maxLoadedPages, NavBar::pageUnloadTimeout).
+ * Default implementation deletes the page. Reimplement it to save page state before deletion,
+ * the page will be created again by createPage() when it is selected.
+ * @param page Page widget, already removed from navigation bar
+ */
+
+/**
+ * @class NavBarTypedPageFactory
+ * @brief Page factory, which creates widget of type T using its default constructor.
+ */
+
+/**
+ * @class NavBarPageHost
+ * @brief Container for lazily created page, used internally by NavBar.
+ *
+ * Host is placed into NavBar stacked widget instead of page and creates page widget on demand.
+ */
+
+/**
+ * Constructs new page host.
+ * @param factory Page factory, host takes ownership of it
+ * @param parent Parent widget
+ */
+NavBarPageHost::NavBarPageHost(NavBarPageFactory *factory, QWidget *parent):
+    QWidget(parent)
+{
+    pageFactory    = factory;
+    content        = 0;
+    activationTime = 0;
+
+    QVBoxLayout *l = new QVBoxLayout;
+    l->setSpacing(0);
+    l->setContentsMargins(0, 0, 0, 0);
+    setLayout(l);
+}
+
+NavBarPageHost::~NavBarPageHost()
+{
+    // page may use objects, owned by factory
+    delete content;
+    delete pageFactory;
+}
+
+/**
+ * Returns page widget, or 0 if page is not created yet.
+ * @return Page widget
+ */
+QWidget *NavBarPageHost::page() const
+{
+    return content;
+}
+
+/**
+ * Returns factory, which creates page widget.
+ * @return Page factory
+ */
+NavBarPageFactory *NavBarPageHost::factory() const
+{
+    return pageFactory;
+}
+
+/**
+ * Returns true if page widget is created.
+ * @return Created or not
+ */
+bool NavBarPageHost::isCreated() const
+{
+    return content != 0;
+}
+
+/**
+ * Creates page widget using factory, if it is not created yet.
+ * @return Page widget
+ */
+QWidget *NavBarPageHost::create()
+{
+    if(!content && pageFactory)
+    {
+        content = pageFactory->createPage();
+
+        if(content)
+            layout()->addWidget(content);
+    }
+
+    return content;
+}
+
+/**
+ * Removes page widget from host and passes it to NavBarPageFactory::releasePage().
+ */
+void NavBarPageHost::release()
+{
+    if(!content)
+        return;
+
+    QWidget *page = content;
+    content = 0;
+
+    layout()->removeWidget(page);
+    page->setParent(0);
+
+    if(pageFactory)
+        pageFactory->releasePage(page);
+    else
+        delete page;
+}
+
+/**
+ * Returns time, when page was current last time.
+ * @return Time in milliseconds
+ */
+qint64 NavBarPageHost::lastActivated() const
+{
+    return activationTime;
+}
+
+/**
+ * Sets time, when page was current last time.
+ * @param time Time in milliseconds
+ */
+void NavBarPageHost::setLastActivated(qint64 time)
+{
+    activationTime = time;
+}
@@ -3,6 +3,9 @@
 
 #include <QAction>
 #include <QToolButton>
+#include <QWidget>
+#include <QHash>
+#include <QVariant>
 
 struct NavBarPage
 {
@@ -10,18 +13,63 @@ struct NavBarPage
     QAction     *action;
 
     inline void    setText(const QString &text)   { action->setText(text);       }
-    inline void    setIcon(const QIcon &icon)     { action->setIcon(icon);       }
+    inline void    setIcon(const QIcon &icon)     { action->setProperty("navBarIcon", QVariant::fromValue(icon));
+                                                    action->setIcon(icon);       }
+    inline void    setDisplayIcon(const QIcon &icon) { action->setIcon(icon);    }
     inline void    setName(const QString &name)   { action->setObjectName(name); }
     inline void    setEnabled(bool enabled)       { action->setEnabled(enabled); }
+    inline void    setBadge(const QString &badge) { action->setProperty("navBarBadge", badge); }
     inline void    setVisible(bool visible)       { action->setVisible(visible);
-                                                    button->setVisible(visible); }
+                                                    if(button) button->setVisible(visible); }
     inline QString text() const                   { return action->text();       }
-    inline QIcon   icon() const                   { return action->icon();       }
+    inline QIcon   icon() const                   { return action->property("navBarIcon").value<QIcon>(); }
     inline QString name() const                   { return action->objectName(); }
+    inline QString badge() const                  { return action->property("navBarBadge").toString(); }
     inline bool    isEnabled() const              { return action->isEnabled();  }
     inline bool    isVisible() const              { return action->isVisible();  }
 };
 
+class NavBarPageFactory
+{
+public:
+    virtual ~NavBarPageFactory() {}
+    virtual QWidget *createPage() = 0;
+    virtual void     releasePage(QWidget *page) { delete page; }
+};
+
+template <class T>
+class NavBarTypedPageFactory: public NavBarPageFactory
+{
+public:
+    QWidget *createPage() { return new T; }
+};
+
+Q_DECLARE_METATYPE(NavBarPageFactory *)
+
+class NavBarPageHost: public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit NavBarPageHost(NavBarPageFactory *factory, QWidget *parent = 0);
+    ~NavBarPageHost();
+
+    QWidget *page() const;
+    NavBarPageFactory *factory() const;
+    bool     isCreated() const;
+    QWidget *create();
+    void     release();
+
+    qint64   lastActivated() const;
+    void     setLastActivated(qint64 time);
+
+private:
+    NavBarPageFactory *pageFactory;
+    QWidget           *content;
+    qint64             activationTime;
+};
+
 QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStringList &order);
+QList<NavBarPage> sortNavBarPageList(const QList<NavBarPage> &pages, const QStringList &order, const QHash<QString, int> &nameIndex);
 
 #endif // NAVBARPAGE_H
@@ -1,5 +1,7 @@
 #include <QResizeEvent>
 #include <QDebug>
+#include <QPainter>
+#include <QStyleOptionToolButton>
 #include "navbar.h"
 #include "navbarpagelistwidget.h"
 
@@ -25,13 +27,80 @@ void NavBarPageListWidget::setRowHeight(int newHeight)
     setMaximumHeight(navBar->visiblePages().size() * pageButtonHeight);
 }
 
-void NavBarPageListWidget::layoutButtons(int width)
+/*
+ * Places buttons of visible pages starting from row first; buttons above it are already in place.
+ * Virtualized list is always laid out completely, it has only as many buttons as fit into widget.
+ */
+void NavBarPageListWidget::layoutButtons(int width, int first)
 {
-    for(int i = 0; i < navBar->visiblePages().size(); i++)
+    NavBarStatsScope statsScope(navBar->collectStats(), NavBarStats::LayoutButtons);
+
+    const QList<NavBarPage> &pages = navBar->visiblePages();
+
+    if(!navBar->virtualList)
     {
-        navBar->visiblePages()[i].button->setGeometry(0, i * pageButtonHeight, width, pageButtonHeight);
-        navBar->visiblePages()[i].button->setToolTip("");
+        for(int i = qMax(0, first); i < pages.size(); i++)
+        {
+            pages[i].button->setGeometry(0, i * pageButtonHeight, width, pageButtonHeight);
+            pages[i].button->setToolTip(navBar->collapsedState ? pages[i].text() : QString());
+        }
+        return;
     }
+
+    // virtualized list: buttons are created only for rows, which fit into widget, and rebound to pages
+    int rows = qMin(pages.size(), (height() + pageButtonHeight - 1) / pageButtonHeight);
+
+    while(buttonPool.size() < rows)
+        buttonPool.append(navBar->createPageButton());
+
+    for(int i = 0; i < buttonPool.size(); i++)
+    {
+        QToolButton *button = buttonPool[i];
+
+        if(i < rows)
+        {
+            QAction *action = pages[i].action;
+            if(button->defaultAction() != action)
+            {
+                if(button->defaultAction())
+                    button->removeAction(button->defaultAction());
+                button->setDefaultAction(action);
+            }
+
+            button->setGeometry(0, i * pageButtonHeight, width, pageButtonHeight);
+            button->setToolTip(navBar->collapsedState ? action->text() : QString());
+            button->setVisible(true);
+        }
+        else
+            button->setVisible(false);
+    }
+}
+
+/**
+ * Returns buttons of virtualized page list.
+ * @return Button pool
+ */
+QList<QToolButton *> NavBarPageListWidget::buttons() const
+{
+    return buttonPool;
+}
+
+/**
+ * Deletes buttons of virtualized page list.
+ */
+void NavBarPageListWidget::clearButtonPool()
+{
+    qDeleteAll(buttonPool);
+    buttonPool.clear();
+}
+
+/**
+ * Returns instrumentation statistics of navigation bar, if they are collected, or 0.
+ * @return Statistics
+ */
+NavBarStats *NavBarPageListWidget::stats() const
+{
+    return navBar->collectStats();
 }
 
 void NavBarPageListWidget::resizeEvent(QResizeEvent *e)
@@ -49,4 +118,119 @@ void NavBarPageListWidget::resizeEvent(QResizeEvent *e)
 NavBarButton::NavBarButton(QWidget *parent):
     QToolButton(parent)
 {
+    navBarTheme = 0;
+}
+
+void NavBarButton::setTheme(const NavBarTheme *theme)
+{
+    navBarTheme = theme;
+    setAttribute(Qt::WA_Hover, true);
+    update();
+}
+
+void NavBarButton::paintEvent(QPaintEvent *e)
+{
+    // page buttons are always children of page list widget
+    NavBarStatsScope statsScope(static_cast<NavBarPageListWidget *>(parentWidget())->stats(), NavBarStats::Paint);
+
+    if(!navBarTheme)
+    {
+        QToolButton::paintEvent(e);
+
+        QPainter p(this);
+        paintBadge(this, &p);
+        return;
+    }
+
+    NavBarTheme::ButtonState state;
+    if(isDown())
+        state = NavBarTheme::Pressed;
+    else if(underMouse())
+        state = isChecked() ? NavBarTheme::HoverChecked : NavBarTheme::Hover;
+    else
+        state = isChecked() ? NavBarTheme::Checked : NavBarTheme::Normal;
+
+    QPainter p(this);
+    navBarTheme->buttonFill[state].paint(&p, rect());
+    p.setPen(navBarTheme->borderColor);
+    p.drawLine(0, 0, width()-1, 0);
+
+    QStyleOptionToolButton opt;
+    initStyleOption(&opt);
+    opt.rect = rect().adjusted(0, 1, 0, 0);
+    opt.state &= ~(QStyle::State_Sunken | QStyle::State_On);
+    opt.font.setBold(true);
+    opt.palette.setColor(QPalette::ButtonText, isEnabled() ? navBarTheme->buttonTextColor[state] : QColor(128, 128, 128));
+    style()->drawControl(QStyle::CE_ToolButtonLabel, &opt, &p, this);
+
+    paintBadge(this, &p);
+}
+
+/*
+ * Paints badge of button's page action. Badge is drawn in the top right corner of icon-only buttons,
+ * and at the right side of buttons with text. It is painted over button content, so size hint is not affected.
+ */
+void NavBarButton::paintBadge(QToolButton *button, QPainter *painter)
+{
+    QAction *action = button->defaultAction();
+    QString badge = action ? action->property("navBarBadge").toString() : QString();
+
+    if(badge.isEmpty())
+        return;
+
+    QFont font = button->font();
+    font.setBold(true);
+    if(font.pointSizeF() > 0)
+        font.setPointSizeF(font.pointSizeF() * 0.8);
+
+    QFontMetrics fm(font);
+    int h = fm.height();
+    QRect rect(0, 0, qMax(h, fm.width(badge) + h / 2), h);
+
+    if(button->toolButtonStyle() == Qt::ToolButtonIconOnly)
+        rect.moveTopRight(button->rect().topRight() + QPoint(-1, 2));
+    else
+    {
+        rect.moveCenter(button->rect().center());
+        rect.moveRight(button->rect().right() - h / 2);
+    }
+
+    painter->save();
+    painter->setRenderHint(QPainter::Antialiasing, true);
+    painter->setPen(Qt::NoPen);
+    painter->setBrush(button->isEnabled() ? QColor(215, 40, 40) : QColor(128, 128, 128));
+    painter->drawRoundedRect(rect, h / 2.0, h / 2.0);
+    painter->setFont(font);
+    painter->setPen(Qt::white);
+    painter->drawText(rect, Qt::AlignCenter, badge);
+    painter->restore();
+}
+
+/*
+ * Transparent widget, which covers toolbar button and paints badge of its page action.
+ * Toolbar creates its buttons itself, so badge can not be painted by button's own paintEvent;
+ * child widget is painted right after its parent, and does not take mouse events from it.
+ */
+NavBarBadgeOverlay::NavBarBadgeOverlay(QToolButton *button):
+    QWidget(button)
+{
+    toolButton = button;
+    setAttribute(Qt::WA_TransparentForMouseEvents, true);
+    setGeometry(button->rect());
+    button->installEventFilter(this);
+    show();
+}
+
+bool NavBarBadgeOverlay::eventFilter(QObject *o, QEvent *e)
+{
+    if((o == toolButton) && (e->type() == QEvent::Resize))
+        setGeometry(toolButton->rect());
+
+    return QWidget::eventFilter(o, e);
+}
+
+void NavBarBadgeOverlay::paintEvent(QPaintEvent *)
+{
+    QPainter p(this);
+    NavBarButton::paintBadge(toolButton, &p);
 }
@@ -4,8 +4,10 @@
 #include <QWidget>
 #include <QList>
 #include <QToolButton>
+#include "navbartheme.h"
 
 class NavBar;
+struct NavBarStats;
 
 class NavBarButton: public QToolButton
 {
@@ -13,6 +15,31 @@ class NavBarButton: public QToolButton
 
 public:
     explicit NavBarButton(QWidget *parent);
+
+    void setTheme(const NavBarTheme *theme);
+
+    static void paintBadge(QToolButton *button, QPainter *painter);
+
+protected:
+    void paintEvent(QPaintEvent *e);
+
+private:
+    const NavBarTheme *navBarTheme;
+};
+
+class NavBarBadgeOverlay: public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit NavBarBadgeOverlay(QToolButton *button);
+
+protected:
+    bool eventFilter(QObject *o, QEvent *e);
+    void paintEvent(QPaintEvent *e);
+
+private:
+    QToolButton *toolButton;
 };
 
 class NavBarPageListWidget : public QWidget
@@ -26,7 +53,12 @@ public:
 
     int  rowHeight() const;
     void setRowHeight(int newHeight);
-    void layoutButtons(int width);
+    void layoutButtons(int width, int first = 0);
+
+    QList<QToolButton *> buttons() const;
+    void clearButtonPool();
+
+    NavBarStats *stats() const;
 
 signals:
     void buttonVisibilityChanged(int visCount);
@@ -37,6 +69,7 @@ protected:
 private:
     NavBar *navBar;
     int     pageButtonHeight;
+    QList<QToolButton *> buttonPool; // reused buttons of virtualized page list
 };
 
 #endif // NAVBARPAGELIST_H
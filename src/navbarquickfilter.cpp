@@ -0,0 +1,272 @@
+#include <QKeyEvent>
+#include <QVBoxLayout>
+#include <QApplication>
+#include <algorithm>
+#include "navbarquickfilter.h"
+
+/**
+ * @class NavBarSearchIndex
+ * @brief Index of page texts, used by quick filter of navigation bar.
+ *
+ * Texts are stored case folded, so search is case insensitive. Page matches, if its text contains search string;
+ * pages, which text starts with search string, go first. When search string is extended, as it happens while user types,
+ * only pages, matched by previous search, are checked again.
+ */
+
+NavBarSearchIndex::NavBarSearchIndex()
+{
+    lastValid = false;
+}
+
+/**
+ * Adds page action to index, or updates its text, if action is already indexed.
+ * @param action Page action
+ * @param text Page text
+ */
+void NavBarSearchIndex::insert(QAction *action, const QString &text)
+{
+    QHash<QAction *, int>::const_iterator it = positions.constFind(action);
+
+    if(it == positions.constEnd())
+    {
+        Entry entry;
+        entry.action = action;
+        entry.key    = text.toCaseFolded();
+        positions.insert(action, entries.size());
+        entries.append(entry);
+    }
+    else
+        entries[it.value()].key = text.toCaseFolded();
+
+    lastValid = false;
+}
+
+/**
+ * Removes page action from index.
+ * @param action Page action
+ */
+void NavBarSearchIndex::remove(QAction *action)
+{
+    int pos = positions.value(action, -1);
+    if(pos < 0)
+        return;
+
+    // last entry takes place of removed one, so removal does not shift entries
+    int last = entries.size() - 1;
+    if(pos != last)
+    {
+        entries[pos] = entries[last];
+        positions[entries[pos].action] = pos;
+    }
+
+    entries.remove(last);
+    positions.remove(action);
+    lastValid = false;
+}
+
+/**
+ * Removes all actions from index.
+ */
+void NavBarSearchIndex::clear()
+{
+    entries.clear();
+    positions.clear();
+    lastValid = false;
+}
+
+/**
+ * Returns number of indexed actions.
+ * @return Number of actions
+ */
+int NavBarSearchIndex::size() const
+{
+    return entries.size();
+}
+
+struct NavBarSearchMatch
+{
+    bool     prefix;
+    int      page;
+    QAction *action;
+
+    bool operator<(const NavBarSearchMatch &other) const
+    {
+        if(prefix != other.prefix)
+            return prefix;
+        return page < other.page;
+    }
+};
+
+/**
+ * Finds enabled and visible pages, which text contains given string.
+ * Pages, hidden by user, stay in index, so showing them again does not rebuild it.
+ * @param text Search string
+ * @param limit Maximum number of results
+ * @return Actions of found pages, prefix matches first, then in page order
+ */
+QList<QAction *> NavBarSearchIndex::find(const QString &text, int limit)
+{
+    QString key = text.trimmed().toCaseFolded();
+
+    QVector<int> matches;
+    if(lastValid && key.startsWith(lastKey))
+    {
+        foreach(int i, lastMatches)
+            if(entries[i].key.contains(key))
+                matches.append(i);
+    }
+    else
+    {
+        for(int i = 0; i < entries.size(); i++)
+            if(entries[i].key.contains(key))
+                matches.append(i);
+    }
+
+    lastKey     = key;
+    lastMatches = matches;
+    lastValid   = true;
+
+    QVector<NavBarSearchMatch> found;
+    found.reserve(matches.size());
+
+    foreach(int i, matches)
+    {
+        if(!entries[i].action->isEnabled() || !entries[i].action->isVisible())
+            continue;
+
+        NavBarSearchMatch m;
+        m.prefix = entries[i].key.startsWith(key);
+        m.page   = entries[i].action->data().toInt();
+        m.action = entries[i].action;
+        found.append(m);
+    }
+
+    int count = qMin(qMax(limit, 0), found.size());
+    std::partial_sort(found.begin(), found.begin() + count, found.end());
+
+    QList<QAction *> result;
+    for(int i = 0; i < count; i++)
+        result.append(found[i].action);
+
+    return result;
+}
+
+
+/**
+ * @class NavBarQuickFilter
+ * @brief Popup, which allows to select navigation bar page by typing part of its text.
+ * @sa NavBar::showQuickFilter()
+ */
+
+/**
+ * @fn NavBarQuickFilter::activated
+ * This signal is emitted when user selects page from search results.
+ * @param action Page action
+ */
+
+static const int maxResults = 50;
+
+/**
+ * Constructs quick filter popup.
+ * @param index Page text index, owned by navigation bar
+ * @param parent Parent widget
+ */
+NavBarQuickFilter::NavBarQuickFilter(NavBarSearchIndex *index, QWidget *parent):
+    QFrame(parent, Qt::Popup)
+{
+    searchIndex = index;
+
+    setObjectName("navBarQuickFilter"); //for stylesheets
+    setFrameStyle(QFrame::Panel | QFrame::Plain);
+
+    filterEdit = new QLineEdit(this);
+#if QT_VERSION >= 0x040700
+    filterEdit->setPlaceholderText(tr("Go to page"));
+#endif
+    filterEdit->installEventFilter(this);
+
+    resultList = new QListWidget(this);
+    resultList->setFocusPolicy(Qt::NoFocus);
+    resultList->setUniformItemSizes(true);
+
+    QVBoxLayout *l = new QVBoxLayout;
+    l->setSpacing(2);
+    l->setContentsMargins(2, 2, 2, 2);
+    l->addWidget(filterEdit);
+    l->addWidget(resultList);
+    setLayout(l);
+
+    connect(filterEdit, SIGNAL(textChanged(QString)),           SLOT(updateResults(QString)));
+    connect(resultList, SIGNAL(itemClicked(QListWidgetItem*)), SLOT(activateItem(QListWidgetItem*)));
+}
+
+/**
+ * Shows popup with empty search string.
+ * @param pos Top left corner of popup in global coordinates
+ * @param width Popup width
+ */
+void NavBarQuickFilter::popup(const QPoint &pos, int width)
+{
+    if(filterEdit->text().isEmpty())
+        updateResults(QString());
+    else
+        filterEdit->clear();
+
+    resize(width, 300);
+    move(pos);
+    show();
+    filterEdit->setFocus();
+}
+
+/* Navigation keys are passed from line edit to result list, so user does not need to leave line edit */
+bool NavBarQuickFilter::eventFilter(QObject *obj, QEvent *e)
+{
+    if((obj == filterEdit) && (e->type() == QEvent::KeyPress))
+    {
+        switch(static_cast<QKeyEvent *>(e)->key())
+        {
+        case Qt::Key_Up:
+        case Qt::Key_Down:
+        case Qt::Key_PageUp:
+        case Qt::Key_PageDown:
+            QApplication::sendEvent(resultList, e);
+            return true;
+
+        case Qt::Key_Return:
+        case Qt::Key_Enter:
+            activateItem(resultList->currentItem());
+            return true;
+
+        case Qt::Key_Escape:
+            hide();
+            return true;
+        }
+    }
+
+    return QFrame::eventFilter(obj, e);
+}
+
+void NavBarQuickFilter::updateResults(const QString &text)
+{
+    results = searchIndex->find(text, maxResults);
+
+    resultList->clear();
+    foreach(QAction *action, results)
+        resultList->addItem(new QListWidgetItem(action->icon(), action->text()));
+
+    if(resultList->count() > 0)
+        resultList->setCurrentRow(0);
+}
+
+void NavBarQuickFilter::activateItem(QListWidgetItem *item)
+{
+    if(!item)
+        return;
+
+    QAction *action = results.value(resultList->row(item));
+
+    hide();
+
+    if(action)
+        emit activated(action);
+}
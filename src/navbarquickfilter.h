@@ -0,0 +1,64 @@
+#ifndef NAVBARQUICKFILTER_H
+#define NAVBARQUICKFILTER_H
+
+#include <QFrame>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QAction>
+#include <QHash>
+#include <QVector>
+
+class NavBarSearchIndex
+{
+public:
+    NavBarSearchIndex();
+
+    void insert(QAction *action, const QString &text);
+    void remove(QAction *action);
+    void clear();
+    int  size() const;
+
+    QList<QAction *> find(const QString &text, int limit);
+
+private:
+    struct Entry
+    {
+        QAction *action;
+        QString  key;
+    };
+
+    QVector<Entry>       entries;
+    QHash<QAction *, int> positions;
+
+    QString      lastKey;     // query of the last search
+    QVector<int> lastMatches; // entries, matched by the last search
+    bool         lastValid;
+};
+
+class NavBarQuickFilter : public QFrame
+{
+    Q_OBJECT
+
+public:
+    explicit NavBarQuickFilter(NavBarSearchIndex *index, QWidget *parent = 0);
+
+    void popup(const QPoint &pos, int width);
+
+signals:
+    void activated(QAction *action);
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *e);
+
+private slots:
+    void updateResults(const QString &text);
+    void activateItem(QListWidgetItem *item);
+
+private:
+    NavBarSearchIndex *searchIndex;
+    QLineEdit         *filterEdit;
+    QListWidget       *resultList;
+    QList<QAction *>   results;
+};
+
+#endif // NAVBARQUICKFILTER_H
@@ -1,4 +1,5 @@
 #include <QMouseEvent>
+#include <QPainter>
 #include "navbarsplitter.h"
 
 /**
@@ -33,6 +34,36 @@ void NavBarSplitter::setIncrement(int inc)
     qobject_cast<NavBarSplitterHandle *>(handle(1))->increment = inc;
 }
 
+/**
+ * Sets theme, used to paint splitter handle. If theme is 0, handle is painted by style (and style sheet).
+ * @param theme Theme, owned by navigation bar
+ */
+void NavBarSplitter::setTheme(const NavBarTheme *theme)
+{
+    NavBarSplitterHandle *h = qobject_cast<NavBarSplitterHandle *>(handle(1));
+    h->theme = theme;
+    h->update();
+}
+
+/**
+ * Returns number of times, splitter handle was moved by mouse since creation or last resetRelayoutCount() call.
+ * Each move causes relayout of page list and toolbar.
+ * @return Number of relayouts
+ */
+int NavBarSplitter::relayoutCount() const
+{
+    return qobject_cast<NavBarSplitterHandle *>(handle(1))->relayouts;
+}
+
+/**
+ * Resets relayout counter.
+ * @sa relayoutCount()
+ */
+void NavBarSplitter::resetRelayoutCount()
+{
+    qobject_cast<NavBarSplitterHandle *>(handle(1))->relayouts = 0;
+}
+
 QSplitterHandle *NavBarSplitter::createHandle()
 {
     return new NavBarSplitterHandle(orientation(), this);
@@ -45,6 +76,16 @@ NavBarSplitterHandle::NavBarSplitterHandle(Qt::Orientation orientation, QSplitte
     mouseOffset = 0;
     pressed     = false;
     increment   = 32;
+    relayouts   = 0;
+    theme       = 0;
+    lastPos     = -1;
+    pendingPos  = 0;
+    movePending = false;
+
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(16);
+    connect(frameTimer, SIGNAL(timeout()), SLOT(applyPendingMove()));
 }
 
 void NavBarSplitterHandle::mousePressEvent(QMouseEvent *e)
@@ -53,6 +94,7 @@ void NavBarSplitterHandle::mousePressEvent(QMouseEvent *e)
     {
         mouseOffset = e->pos().y();
         pressed = true;
+        lastPos = -1;
         update();
     }
 }
@@ -67,5 +109,66 @@ void NavBarSplitterHandle::mouseMoveEvent(QMouseEvent *e)
     int reversePos = sh - pos;
     int newPos     = sh - (reversePos - (reversePos % increment)) - height();
 
-    moveSplitter(newPos);
+    // splitter is moved only when handle crosses row boundary, and not more often than once per frame
+    if(newPos == lastPos)
+        return;
+
+    lastPos = newPos;
+
+    if(frameTimer->isActive())
+    {
+        pendingPos  = newPos;
+        movePending = true;
+    }
+    else
+        moveTo(newPos);
+}
+
+void NavBarSplitterHandle::mouseReleaseEvent(QMouseEvent *e)
+{
+    frameTimer->stop();
+    applyPendingMove();
+
+    QSplitterHandle::mouseReleaseEvent(e);
+}
+
+void NavBarSplitterHandle::applyPendingMove()
+{
+    if(!movePending)
+        return;
+
+    movePending = false;
+    moveTo(pendingPos);
+}
+
+void NavBarSplitterHandle::moveTo(int pos)
+{
+    moveSplitter(pos);
+    relayouts++;
+    frameTimer->start();
+}
+
+void NavBarSplitterHandle::paintEvent(QPaintEvent *e)
+{
+    if(!theme)
+    {
+        QSplitterHandle::paintEvent(e);
+        return;
+    }
+
+    QPainter p(this);
+    theme->splitterFill.paint(&p, rect());
+
+    if(theme->splitterLineColor.isValid())
+    {
+        p.setPen(theme->splitterLineColor);
+        p.drawLine(0, 0, width()-1, 0);
+    }
+
+    if(!theme->splitterGrip.isNull())
+    {
+        QRect r = theme->splitterGrip.rect();
+        r.moveCenter(rect().center());
+        p.drawPixmap(r.topLeft(), theme->splitterGrip);
+    }
 }
@@ -2,6 +2,8 @@
 #define NAVBARSPLITTER_H
 
 #include <QSplitter>
+#include <QTimer>
+#include "navbartheme.h"
 
 class NavBarSplitter : public QSplitter
 {
@@ -15,6 +17,10 @@ public:
 
     int  increment() const;
     void setIncrement(int inc);
+    void setTheme(const NavBarTheme *theme);
+
+    int  relayoutCount() const;
+    void resetRelayoutCount();
 
 protected:
     QSplitterHandle *createHandle();
@@ -28,14 +34,27 @@ public:
     explicit NavBarSplitterHandle(Qt::Orientation orientation, QSplitter *parent);
 
     int increment;
+    int relayouts;
+    const NavBarTheme *theme;
 
 protected:
     void mousePressEvent(QMouseEvent *e);
     void mouseMoveEvent(QMouseEvent *e);
+    void mouseReleaseEvent(QMouseEvent *e);
+    void paintEvent(QPaintEvent *e);
+
+private slots:
+    void applyPendingMove();
 
 private:
-    int  mouseOffset;
-    bool pressed;
+    void moveTo(int pos);
+
+    int     mouseOffset;
+    bool    pressed;
+    int     lastPos;
+    int     pendingPos;
+    bool    movePending;
+    QTimer *frameTimer;
 };
 
 #endif // NAVBARSPLITTER_H
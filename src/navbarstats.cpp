@@ -0,0 +1,92 @@
+#include <QDebug>
+#include "navbarstats.h"
+
+#if QT_VERSION >= 0x050400
+/*
+ * Debug messages are disabled by default, enable them with logging rule "navbar.stats.debug=true",
+ * e.g. in QT_LOGGING_RULES environment variable.
+ */
+Q_LOGGING_CATEGORY(navBarStatsLog, "navbar.stats", QtWarningMsg)
+#endif
+
+/**
+ * @class NavBarStats
+ * @brief Instrumentation counters of navigation bar.
+ *
+ * Holds number of calls and execution time of internal operations, which are usually responsible
+ * for slow navigation bar: page list recalculation, toolbar and menu refilling, button layout, etc.
+ * Time of an operation includes time of operations, called from it, e.g. RecalcPageList includes LayoutButtons.
+ * @sa NavBar::stats(), NavBar::statsEnabled
+ */
+/**
+ * @var NavBarStats::count
+ * Number of calls of each operation.
+ */
+/**
+ * @var NavBarStats::totalTime
+ * Total execution time of each operation, in nanoseconds.
+ */
+/**
+ * @var NavBarStats::maxTime
+ * Longest single execution of each operation, in nanoseconds.
+ */
+
+/**
+ * Constructs zeroed statistics.
+ */
+NavBarStats::NavBarStats()
+{
+    reset();
+}
+
+/**
+ * Resets all counters to zero.
+ */
+void NavBarStats::reset()
+{
+    for(int i = 0; i < OperationCount; i++)
+    {
+        count[i]     = 0;
+        totalTime[i] = 0;
+        maxTime[i]   = 0;
+    }
+}
+
+/**
+ * Adds one execution of operation. If logging category <TT>navbar.stats</TT> is enabled for debug messages,
+ * execution time is also logged.
+ * @param op Operation
+ * @param nsec Execution time in nanoseconds
+ */
+void NavBarStats::record(Operation op, qint64 nsec)
+{
+    count[op]++;
+    totalTime[op] += nsec;
+    if(nsec > maxTime[op])
+        maxTime[op] = nsec;
+
+#if QT_VERSION >= 0x050400
+    qCDebug(navBarStatsLog) << operationName(op) << double(nsec) / 1000000.0 << "ms";
+#endif
+}
+
+/**
+ * Returns name of the operation, as it is used in log messages.
+ * @param op Operation
+ * @return Operation name
+ */
+const char *NavBarStats::operationName(Operation op)
+{
+    static const char *const names[OperationCount] =
+    {
+        "recalcPageList",
+        "refillToolBar",
+        "refillPagesMenu",
+        "layoutButtons",
+        "reorderStackedWidget",
+        "resizeContent",
+        "paint"
+    };
+
+    return ((op >= 0) && (op < OperationCount)) ? names[op] : "";
+}
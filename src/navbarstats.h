@@ -0,0 +1,59 @@
+#ifndef NAVBARSTATS_H
+#define NAVBARSTATS_H
+
+#include <QtGlobal>
+#include <QElapsedTimer>
+
+#if QT_VERSION >= 0x050400
+#include <QLoggingCategory>
+Q_DECLARE_LOGGING_CATEGORY(navBarStatsLog)
+#endif
+
+struct NavBarStats
+{
+    enum Operation
+    {
+        RecalcPageList,
+        RefillToolBar,
+        RefillPagesMenu,
+        LayoutButtons,
+        ReorderStackedWidget,
+        ResizeContent,
+        Paint,
+        OperationCount
+    };
+
+    NavBarStats();
+
+    void reset();
+    void record(Operation op, qint64 nsec);
+    static const char *operationName(Operation op);
+
+    int    count[OperationCount];
+    qint64 totalTime[OperationCount]; // nanoseconds
+    qint64 maxTime[OperationCount];   // nanoseconds
+};
+
+class NavBarStatsScope
+{
+public:
+    inline NavBarStatsScope(NavBarStats *stats, NavBarStats::Operation op): s(stats), operation(op)
+    {
+        if(s)
+            timer.start();
+    }
+
+    inline ~NavBarStatsScope()
+    {
+        if(s)
+            s->record(operation, timer.nsecsElapsed());
+    }
+
+private:
+    Q_DISABLE_COPY(NavBarStatsScope)
+    NavBarStats           *s;
+    NavBarStats::Operation operation;
+    QElapsedTimer          timer;
+};
+
+#endif // NAVBARSTATS_H
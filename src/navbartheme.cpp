@@ -0,0 +1,260 @@
+#include <QPainter>
+#include <QLinearGradient>
+#include "navbartheme.h"
+
+
+/**
+ * @class NavBarFill
+ * @brief Background fill, used by NavBarTheme.
+ *
+ * Fill is either solid color or vertical linear gradient.
+ * Gradients are rendered once per height into small pixmap tiles, which are reused for painting.
+ */
+/**
+ * @var NavBarFill::stops
+ * Gradient stops. Single stop means solid color.
+ */
+
+/**
+ * Constructs solid fill.
+ * @param color Fill color
+ */
+NavBarFill::NavBarFill(const QColor &color)
+{
+    stops.append(QGradientStop(0.0, color));
+}
+
+/**
+ * Constructs two-color vertical gradient.
+ * @param top Top color
+ * @param bottom Bottom color
+ */
+NavBarFill::NavBarFill(const QColor &top, const QColor &bottom)
+{
+    stops.append(QGradientStop(0.0, top));
+    stops.append(QGradientStop(1.0, bottom));
+}
+
+/**
+ * Constructs "glass" vertical gradient with sharp transition in the upper half, like one used in Office 2007 themes.
+ * @param top Top color
+ * @param upper Color above transition
+ * @param lower Color below transition
+ * @param bottom Bottom color
+ */
+NavBarFill::NavBarFill(const QColor &top, const QColor &upper, const QColor &lower, const QColor &bottom)
+{
+    stops.append(QGradientStop(0.0,  top));
+    stops.append(QGradientStop(0.4,  upper));
+    stops.append(QGradientStop(0.42, lower));
+    stops.append(QGradientStop(1.0,  bottom));
+}
+
+/**
+ * Fills rectangle.
+ * @param painter Painter
+ * @param rect Rectangle to fill
+ */
+void NavBarFill::paint(QPainter *painter, const QRect &rect) const
+{
+    if(stops.isEmpty() || rect.isEmpty())
+        return;
+
+    if(stops.size() == 1)
+    {
+        painter->fillRect(rect, stops.first().second);
+        return;
+    }
+
+    QHash<int, QPixmap>::const_iterator it = pixmaps.constFind(rect.height());
+    if(it == pixmaps.constEnd())
+    {
+        if(pixmaps.size() >= 16) // heights change rarely, so just drop everything
+            pixmaps.clear();
+
+        QLinearGradient gradient(0, 0, 0, rect.height());
+        gradient.setStops(stops);
+
+        QPixmap tile(16, rect.height());
+        QPainter p(&tile);
+        p.fillRect(tile.rect(), gradient);
+        p.end();
+
+        it = pixmaps.insert(rect.height(), tile);
+    }
+
+    painter->drawTiledPixmap(rect, it.value());
+}
+
+
+/**
+ * @class NavBarTheme
+ * @brief Colors, used by navigation bar in native painting mode.
+ *
+ * Native painting mode is a fast alternative to style sheets: navigation bar and its parts draw themselves
+ * directly from theme colors, instead of resolving style sheet rules on every paint.
+ * Presets are equivalent to style sheets, included in navbar resources.
+ * @sa NavBar::setTheme()
+ */
+
+/**
+ * Constructs empty (invalid) theme. Navigation bar, which has invalid theme, uses style sheets and QStyle for painting.
+ */
+NavBarTheme::NavBarTheme()
+{
+}
+
+static void setOffice2003Buttons(NavBarTheme &t)
+{
+    t.buttonFill[NavBarTheme::Hover]        = NavBarFill(QColor(255, 255, 220), QColor(247, 192, 91));
+    t.buttonFill[NavBarTheme::HoverChecked] = NavBarFill(QColor(232, 127, 8),   QColor(248, 219, 124));
+    t.buttonFill[NavBarTheme::Checked]      = NavBarFill(QColor(251, 230, 148), QColor(239, 150, 21));
+    t.buttonFill[NavBarTheme::Pressed]      = t.buttonFill[NavBarTheme::HoverChecked];
+
+    t.titleColor[NavBarTheme::Hover]   = QColor(255, 231, 162);
+    t.titleColor[NavBarTheme::Pressed] = QColor(251, 140, 60);
+}
+
+static void setOffice2007Buttons(NavBarTheme &t)
+{
+    t.buttonFill[NavBarTheme::Hover]        = NavBarFill(QColor(255, 254, 228), QColor(255, 233, 168), QColor(255, 215, 103), QColor(255, 230, 159));
+    t.buttonFill[NavBarTheme::HoverChecked] = NavBarFill(QColor(255, 189, 105), QColor(255, 173, 67),  QColor(251, 140, 60),  QColor(255, 211, 101));
+    t.buttonFill[NavBarTheme::Checked]      = NavBarFill(QColor(255, 217, 170), QColor(255, 187, 110), QColor(255, 171, 63),  QColor(254, 225, 122));
+    t.buttonFill[NavBarTheme::Pressed]      = t.buttonFill[NavBarTheme::Checked];
+
+    t.headerLineColor = Qt::white;
+
+    t.titleColor[NavBarTheme::Hover]   = QColor(255, 231, 162);
+    t.titleColor[NavBarTheme::Pressed] = QColor(251, 140, 60);
+}
+
+/**
+ * Returns theme, equivalent to one of bundled style sheets.
+ * @param preset Theme preset
+ * @return Theme
+ */
+NavBarTheme NavBarTheme::preset(Preset preset)
+{
+    NavBarTheme t;
+    t.contentColor   = Qt::white;
+    t.titleTextColor = Qt::black;
+
+    for(int i = 0; i < ButtonStateCount; i++)
+        t.buttonTextColor[i] = Qt::black;
+
+    switch(preset)
+    {
+    case Office2003Gray:
+        t.borderColor     = QColor(128, 128, 128);
+        t.popupColor      = QColor(213, 210, 202);
+        t.headerFill      = NavBarFill(QColor(128, 128, 128));
+        t.headerTextColor = Qt::white;
+        t.splitterFill    = NavBarFill(QColor(212, 208, 200), QColor(142, 141, 140));
+        t.splitterGrip    = QPixmap(":/styles/splitter2003gray.png");
+        t.buttonFill[Normal]       = NavBarFill(QColor(255, 255, 255), QColor(213, 210, 202));
+        t.buttonFill[Hover]        = NavBarFill(QColor(182, 189, 210));
+        t.buttonFill[HoverChecked] = NavBarFill(QColor(133, 146, 181));
+        t.buttonFill[Checked]      = NavBarFill(QColor(212, 213, 216));
+        t.buttonFill[Pressed]      = t.buttonFill[HoverChecked];
+        t.buttonTextColor[HoverChecked] = Qt::white;
+        t.buttonTextColor[Pressed]      = Qt::white;
+        t.toolBarFill     = NavBarFill(QColor(253, 253, 253), QColor(190, 190, 190));
+        t.titleColor[Normal]  = QColor(235, 235, 235);
+        t.titleColor[Hover]   = QColor(182, 189, 210);
+        t.titleColor[Pressed] = QColor(133, 146, 181);
+        break;
+
+    case Office2003Blue:
+        setOffice2003Buttons(t);
+        t.borderColor     = QColor(0, 45, 150);
+        t.popupColor      = QColor(126, 166, 225);
+        t.headerFill      = NavBarFill(QColor(89, 135, 214), QColor(5, 57, 148));
+        t.headerTextColor = Qt::white;
+        t.splitterFill    = NavBarFill(QColor(89, 135, 214), QColor(15, 67, 157));
+        t.splitterGrip    = QPixmap(":/styles/splitter2003blue.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(203, 225, 252), QColor(126, 166, 225));
+        t.toolBarFill     = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(203, 225, 252);
+        t.titleTextColor  = QColor(21, 66, 139);
+        break;
+
+    case Office2003Green:
+        setOffice2003Buttons(t);
+        t.borderColor     = QColor(96, 128, 88);
+        t.popupColor      = QColor(178, 193, 140);
+        t.headerFill      = NavBarFill(QColor(175, 192, 130), QColor(99, 122, 69));
+        t.headerTextColor = Qt::white;
+        t.splitterFill    = NavBarFill(QColor(120, 142, 111), QColor(73, 91, 68));
+        t.splitterGrip    = QPixmap(":/styles/splitter2003green.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(234, 240, 207), QColor(178, 193, 140));
+        t.toolBarFill     = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(234, 240, 207);
+        t.titleTextColor  = QColor(73, 91, 68);
+        break;
+
+    case Office2003Silver:
+        setOffice2003Buttons(t);
+        t.borderColor     = QColor(124, 124, 148);
+        t.popupColor      = QColor(150, 148, 178);
+        t.headerFill      = NavBarFill(QColor(168, 167, 191), QColor(113, 112, 145));
+        t.headerTextColor = Qt::white;
+        t.splitterFill    = NavBarFill(QColor(168, 167, 191), QColor(120, 119, 151));
+        t.splitterGrip    = QPixmap(":/styles/splitter2003silver.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(225, 226, 236), QColor(150, 148, 178));
+        t.toolBarFill     = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(238, 238, 244);
+        t.titleTextColor  = QColor(21, 66, 139);
+        break;
+
+    case Office2007Blue:
+        setOffice2007Buttons(t);
+        t.borderColor       = QColor(101, 147, 207);
+        t.popupColor        = QColor(173, 209, 255);
+        t.headerFill        = NavBarFill(QColor(227, 239, 255), QColor(175, 210, 255));
+        t.headerTextColor   = QColor(21, 66, 139);
+        t.splitterFill      = NavBarFill(QColor(249, 250, 252), QColor(191, 219, 255));
+        t.splitterLineColor = t.borderColor;
+        t.splitterGrip      = QPixmap(":/styles/splitter2007blue.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(227, 239, 255), QColor(196, 221, 255), QColor(173, 209, 255), QColor(192, 219, 255));
+        t.buttonTextColor[Normal] = QColor(21, 66, 139);
+        t.toolBarFill       = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(213, 228, 242);
+        t.titleTextColor    = QColor(21, 66, 139);
+        break;
+
+    case Office2007Black:
+        setOffice2007Buttons(t);
+        t.borderColor       = QColor(167, 173, 182);
+        t.popupColor        = QColor(199, 203, 209);
+        t.headerFill        = NavBarFill(QColor(238, 239, 240), QColor(191, 195, 202));
+        t.headerTextColor   = Qt::black;
+        t.splitterFill      = NavBarFill(QColor(255, 255, 255), QColor(195, 200, 206));
+        t.splitterLineColor = t.borderColor;
+        t.splitterGrip      = QPixmap(":/styles/splitter2007black.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(248, 248, 249), QColor(223, 226, 228), QColor(199, 203, 209), QColor(219, 222, 226));
+        t.toolBarFill       = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(235, 235, 235);
+        break;
+
+    case Office2007Silver:
+        setOffice2007Buttons(t);
+        t.borderColor       = QColor(111, 112, 116);
+        t.popupColor        = QColor(197, 199, 209);
+        t.headerFill        = NavBarFill(QColor(255, 255, 255), QColor(218, 223, 230));
+        t.headerTextColor   = QColor(21, 66, 139);
+        t.splitterFill      = NavBarFill(QColor(255, 255, 255), QColor(119, 118, 151));
+        t.splitterLineColor = t.borderColor;
+        t.splitterGrip      = QPixmap(":/styles/splitter2007silver.png");
+        t.buttonFill[Normal] = NavBarFill(QColor(235, 238, 250), QColor(214, 218, 228), QColor(197, 199, 209), QColor(219, 222, 226));
+        t.buttonTextColor[Normal] = QColor(21, 66, 139);
+        t.toolBarFill       = t.buttonFill[Normal];
+        t.titleColor[Normal] = QColor(238, 238, 244);
+        t.titleTextColor    = QColor(21, 66, 139);
+        break;
+    }
+
+    t.titleColor[Checked]      = t.titleColor[Normal];
+    t.titleColor[HoverChecked] = t.titleColor[Hover];
+
+    return t;
+}
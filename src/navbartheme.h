@@ -0,0 +1,76 @@
+#ifndef NAVBARTHEME_H
+#define NAVBARTHEME_H
+
+#include <QColor>
+#include <QPixmap>
+#include <QGradient>
+#include <QHash>
+#include <QRect>
+
+class QPainter;
+
+struct NavBarFill
+{
+    NavBarFill() {}
+    NavBarFill(const QColor &color);
+    NavBarFill(const QColor &top, const QColor &bottom);
+    NavBarFill(const QColor &top, const QColor &upper, const QColor &lower, const QColor &bottom);
+
+    bool isValid() const { return !stops.isEmpty(); }
+    void paint(QPainter *painter, const QRect &rect) const;
+
+    QGradientStops stops;
+
+private:
+    mutable QHash<int, QPixmap> pixmaps; // pre-rendered gradient tiles, keyed by height
+};
+
+struct NavBarTheme
+{
+    enum Preset
+    {
+        Office2003Gray,
+        Office2003Blue,
+        Office2003Green,
+        Office2003Silver,
+        Office2007Blue,
+        Office2007Black,
+        Office2007Silver
+    };
+
+    enum ButtonState
+    {
+        Normal,
+        Hover,
+        Checked,
+        HoverChecked,
+        Pressed,
+        ButtonStateCount
+    };
+
+    NavBarTheme();
+
+    static NavBarTheme preset(Preset preset);
+    bool isValid() const { return borderColor.isValid(); }
+
+    QColor     borderColor;
+    QColor     contentColor;
+    QColor     popupColor;
+
+    NavBarFill headerFill;
+    QColor     headerLineColor;
+    QColor     headerTextColor;
+
+    NavBarFill splitterFill;
+    QColor     splitterLineColor;
+    QPixmap    splitterGrip;
+
+    NavBarFill buttonFill[ButtonStateCount];
+    QColor     buttonTextColor[ButtonStateCount];
+    NavBarFill toolBarFill;
+
+    QColor     titleColor[ButtonStateCount];
+    QColor     titleTextColor;
+};
+
+#endif // NAVBARTHEME_H
@@ -37,4 +37,12 @@
         <translation>Сброс</translation>
     </message>
 </context>
+<context>
+    <name>NavBarQuickFilter</name>
+    <message>
+        <location filename="navbarquickfilter.cpp" line="183"/>
+        <source>Go to page</source>
+        <translation>Перейти к странице</translation>
+    </message>
+</context>
 </TS>
@@ -9,14 +9,23 @@ SOURCES += navbar.cpp \
     navbarpagelistwidget.cpp \
     navbarsplitter.cpp \
     navbaroptionsdialog.cpp \
-    navbarheader.cpp
+    navbarheader.cpp \
+    navbarpage.cpp \
+    navbartheme.cpp \
+    navbarstats.cpp \
+    navbarquickfilter.cpp \
+    navbargroup.cpp
 
 HEADERS += navbar.h \
     navbarpagelistwidget.h \
     navbarsplitter.h \
     navbaroptionsdialog.h \
     navbarpage.h \
-    navbarheader.h
+    navbarheader.h \
+    navbartheme.h \
+    navbarstats.h \
+    navbarquickfilter.h \
+    navbargroup.h
 
 RESOURCES += \
     navbar.qrc
@@ -0,0 +1,272 @@
+#include <QApplication>
+#include <QBuffer>
+#include <QDataStream>
+#include <QDialog>
+#include <QPushButton>
+#include <QStandardItemModel>
+#include <QtTest>
+#include "navbar.h"
+#include "navbarstatetest.h"
+
+/*
+ * Tests of NavBar state persistence. Truncated, corrupted and mismatching state data must be rejected
+ * without crashing, and navigation bar must stay exactly as it was. Default page order, which options dialog
+ * restores, is tested here too.
+ */
+
+static const int pageCount    = 5;
+static const int stateVersion = 1;
+static const quint32 legacyMarker = 0x4e427232; // NavBar::NavBarMarker, written by previous navbar versions
+
+/* Offset of the records length in state header: marker, format, stream version, user version */
+static const int totalLengthOffset = 12;
+
+static void writeUInt32(QByteArray &data, int offset, quint32 value)
+{
+    data[offset]   = char(value >> 24);
+    data[offset+1] = char(value >> 16);
+    data[offset+2] = char(value >> 8);
+    data[offset+3] = char(value);
+}
+
+void NavBarStateTest::init()
+{
+    navBar = new NavBar;
+
+    for(int i = 0; i < pageCount; i++)
+    {
+        navBar->addPage(new QWidget, QString("Page %1").arg(i));
+        navBar->setPageName(i, QString("page%1").arg(i));
+    }
+
+    // row count is saved from page list height, so navigation bar is laid out
+    navBar->resize(220, 600);
+    navBar->show();
+#if QT_VERSION >= 0x050000
+    QTest::qWaitForWindowExposed(navBar);
+#else
+    QTest::qWaitForWindowShown(navBar);
+#endif
+
+    navBar->setCurrentIndex(2);
+    navBar->setPageVisible(3, false);
+    navBar->setVisibleRows(2);
+
+    reference = navBar->saveState(stateVersion);
+}
+
+void NavBarStateTest::cleanup()
+{
+    delete navBar;
+    navBar = 0;
+}
+
+/* Restores state, which must be rejected, and checks, that navigation bar is not changed */
+void NavBarStateTest::verifyRejected(const QByteArray &state, const char *what)
+{
+    QByteArray before = navBar->saveState(stateVersion);
+    int current = navBar->currentIndex();
+
+    QVERIFY2(!navBar->restoreState(state, stateVersion), what);
+    QVERIFY2(navBar->currentIndex() == current, what);
+    QVERIFY2(navBar->saveState(stateVersion) == before, what);
+}
+
+void NavBarStateTest::validState()
+{
+    navBar->setCurrentIndex(0);
+    navBar->setPageVisible(3, true);
+
+    QVERIFY(navBar->restoreState(reference, stateVersion));
+    QCOMPARE(navBar->currentIndex(), 2);
+    QVERIFY(!navBar->isPageVisible(3));
+    QCOMPARE(navBar->saveState(stateVersion), reference);
+}
+
+void NavBarStateTest::truncatedState()
+{
+    for(int size = 0; size < reference.size(); size++)
+    {
+        QByteArray what = QString("truncated to %1 bytes").arg(size).toLatin1();
+        verifyRejected(reference.left(size), what.constData());
+
+        if(QTest::currentTestFailed())
+            return;
+    }
+}
+
+/*
+ * Some flipped bytes give valid state, e.g. other visibility flag or row count.
+ * Such state may be restored, but any rejected one must leave navigation bar unchanged.
+ */
+void NavBarStateTest::flippedBytes()
+{
+    for(int i = 0; i < reference.size(); i++)
+    {
+        QByteArray state = reference;
+        state[i] = char(state[i] ^ 0xff);
+
+        QByteArray what = QString("byte %1 flipped").arg(i).toLatin1();
+        QByteArray before = navBar->saveState(stateVersion);
+
+        if(navBar->restoreState(state, stateVersion))
+            QVERIFY(navBar->restoreState(reference, stateVersion));
+        else
+            QVERIFY2(navBar->saveState(stateVersion) == before, what.constData());
+
+        if(QTest::currentTestFailed())
+            return;
+    }
+}
+
+void NavBarStateTest::corruptedFields()
+{
+    QByteArray state = reference;
+    state[0] = char(state[0] ^ 0xff);
+    verifyRejected(state, "state marker");
+
+    QVERIFY(!navBar->restoreState(reference, stateVersion + 1));
+    QCOMPARE(navBar->saveState(stateVersion), reference);
+
+    state = reference;
+    writeUInt32(state, totalLengthOffset, 0xffffffff);
+    verifyRejected(state, "records length exceeds data");
+
+    state = reference;
+    writeUInt32(state, totalLengthOffset, 3);
+    verifyRejected(state, "records length ends inside record header");
+
+    // the first record follows the header: quint16 tag, quint32 length
+    state = reference;
+    writeUInt32(state, totalLengthOffset + 4 + 2, 0x7fffffff);
+    verifyRejected(state, "record length exceeds data");
+
+    state = reference;
+    state.append(QByteArray(8, '\xff'));
+    writeUInt32(state, totalLengthOffset, quint32(reference.size() - totalLengthOffset - 4 + 8));
+    verifyRejected(state, "record header with huge length");
+}
+
+void NavBarStateTest::legacyState()
+{
+    QByteArray legacy;
+    QDataStream stream(&legacy, QIODevice::WriteOnly);
+
+    stream << legacyMarker;
+    stream << qint32(stateVersion);
+    stream << qint32(2);        // rows
+    stream << qint32(1);        // current page, in saved order
+    stream << false;            // collapsed
+    stream << qint32(200);      // expanded width
+    stream << qint32(pageCount);
+    for(int i = pageCount-1; i >= 0; i--)
+    {
+        stream << QString("page%1").arg(i);
+        stream << true;
+    }
+
+    for(int size = 0; size < legacy.size(); size++)
+    {
+        QByteArray what = QString("legacy state truncated to %1 bytes").arg(size).toLatin1();
+        verifyRejected(legacy.left(size), what.constData());
+
+        if(QTest::currentTestFailed())
+            return;
+    }
+
+    QVERIFY(!navBar->restoreState(legacy, stateVersion + 1));
+    QCOMPARE(navBar->saveState(stateVersion), reference);
+
+    QVERIFY(navBar->restoreState(legacy, stateVersion));
+    QCOMPARE(navBar->pageName(0), QString("page4"));
+    QCOMPARE(navBar->pageName(pageCount-1), QString("page0"));
+    QCOMPARE(navBar->currentIndex(), 1);
+    QVERIFY(navBar->isPageVisible(1));
+}
+
+/* State does not take the rest of device, so several states, or other data, may follow each other */
+void NavBarStateTest::concatenatedStates()
+{
+    QBuffer buffer;
+    buffer.open(QIODevice::ReadWrite);
+
+    QVERIFY(navBar->saveState(&buffer, stateVersion));
+    qint64 first = buffer.pos();
+    navBar->setCurrentIndex(4);
+    QVERIFY(navBar->saveState(&buffer, stateVersion));
+    buffer.write("tail");
+
+    buffer.seek(0);
+    QVERIFY(navBar->restoreState(&buffer, stateVersion));
+    QCOMPARE(navBar->currentIndex(), 2);
+    QCOMPARE(buffer.pos(), first);
+
+    QVERIFY(navBar->restoreState(&buffer, stateVersion));
+    QCOMPARE(navBar->currentIndex(), 4);
+    QCOMPARE(buffer.read(4), QByteArray("tail"));
+
+    // rejected state leaves device where it was
+    buffer.seek(first);
+    QVERIFY(!navBar->restoreState(&buffer, stateVersion + 1));
+    QCOMPARE(buffer.pos(), first);
+}
+
+/* Clicks "Reset" in options dialog, shown by NavBar::showOptionsDialog(), and accepts it */
+void NavBarStateTest::resetOptionsDialog()
+{
+    QDialog *dlg = qobject_cast<QDialog *>(QApplication::activeModalWidget());
+
+    if(!dlg)
+    {
+        QTimer::singleShot(0, this, SLOT(resetOptionsDialog()));
+        return;
+    }
+
+    QPushButton *resetButton = dlg->findChild<QPushButton *>("resetButton");
+    if(resetButton)
+        resetButton->click();
+    dlg->accept();
+}
+
+/* Default page order, shown by options dialog, must follow removals after model rows are reordered */
+void NavBarStateTest::resetOrderAfterModelMove()
+{
+    QStandardItemModel model;
+    for(int i = pageCount-1; i >= 0; i--)
+        model.appendRow(new QStandardItem(QString("Row %1").arg(i)));
+
+    NavBar modelBar;
+    modelBar.setModel(&model);
+
+    // pages follow rows, which are now in reverse order of insertion
+    model.sort(0);
+    QCOMPARE(modelBar.pageText(0), QString("Row 0"));
+
+    model.removeRow(0);
+    QCOMPARE(modelBar.count(), pageCount-1);
+
+    QTimer::singleShot(0, this, SLOT(resetOptionsDialog()));
+    QCOMPARE(modelBar.showOptionsDialog(), int(QDialog::Accepted));
+
+    QCOMPARE(modelBar.count(), pageCount-1);
+    for(int i = 0; i < pageCount-1; i++)
+    {
+        QCOMPARE(modelBar.pageText(i), QString("Row %1").arg(pageCount-1-i));
+        modelBar.setCurrentIndex(i);
+        QCOMPARE(modelBar.currentIndex(), i);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+#if QT_VERSION >= 0x050000
+    if(qgetenv("QT_QPA_PLATFORM").isEmpty())
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+#endif
+
+    QApplication app(argc, argv);
+    Q_INIT_RESOURCE(navbar);
+
+    NavBarStateTest test;
+    return QTest::qExec(&test, argc, argv);
+}
@@ -0,0 +1,34 @@
+#ifndef NAVBARSTATETEST_H
+#define NAVBARSTATETEST_H
+
+#include <QObject>
+#include <QByteArray>
+
+class NavBar;
+
+class NavBarStateTest : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void init();
+    void cleanup();
+    void validState();
+    void truncatedState();
+    void flippedBytes();
+    void corruptedFields();
+    void legacyState();
+    void concatenatedStates();
+    void resetOrderAfterModelMove();
+
+protected slots:
+    void resetOptionsDialog();
+
+private:
+    void verifyRejected(const QByteArray &state, const char *what);
+
+    NavBar    *navBar;
+    QByteArray reference;
+};
+
+#endif // NAVBARSTATETEST_H
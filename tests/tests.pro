@@ -0,0 +1,23 @@
+# NavBar unit tests. Build together with the library, then run ./tests, or "make check".
+# Offscreen platform is used by default on Qt 5, set QT_QPA_PLATFORM to override.
+
+QT += core gui testlib
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = tests
+TEMPLATE = app
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+SOURCES += navbarstatetest.cpp
+
+HEADERS += navbarstatetest.h
+
+CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../lib/ -lnavbar
+else:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../lib/ -lnavbard
+
+INCLUDEPATH += $$PWD/../src
+DEPENDPATH += $$PWD/../src
+
+CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../lib/libnavbar.a
+else:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../lib/libnavbard.a